@@ -0,0 +1,57 @@
+#!/bin/sh
+# compare.sh <results> <baseline> <threshold %>
+# Compare les medianes d'un rapport BENCH a la reference, echoue si un cas
+# est plus lent que la reference de plus de <threshold> pourcents.
+
+results="$1"
+baseline="$2"
+threshold="${3:-25}"
+
+if ! grep -q '^BENCH done' "$results" 2>/dev/null; then
+	echo "bench: incomplete report in $results (crash or timeout?)"
+	cat "$results" 2>/dev/null
+	exit 1
+fi
+
+if [ ! -f "$baseline" ]; then
+	grep -v '^BENCH done' "$results"
+	echo "bench: no baseline, run 'make bench-baseline' to record one"
+	exit 0
+fi
+
+awk -v threshold="$threshold" '
+function parse(line, fields,    count, index_, pair) {
+	count = split(line, parts, " ")
+	for (index_ = 2; index_ <= count; ++index_) {
+		split(parts[index_], pair, "=")
+		fields[pair[1]] = pair[2]
+	}
+}
+$2 !~ /^name=/ { next }
+NR == FNR {
+	parse($0, base)
+	reference[base["name"]] = base["median"]
+	next
+}
+{
+	parse($0, current)
+	name = current["name"]
+	median = current["median"]
+	if (!(name in reference)) {
+		printf "%-18s %10d cycles  (new)\n", name, median
+		next
+	}
+	old = reference[name]
+	delta = old ? (median - old) * 100 / old : 0
+	status = ""
+	if (median > old * (100 + threshold) / 100) {
+		status = "  REGRESSION"
+		failed = 1
+	}
+	printf "%-18s %10d cycles  %+6.1f%%%s\n", name, median, delta, status
+}
+END {
+	if (failed)
+		printf "bench: median regressed by more than %d%%\n", threshold
+	exit failed
+}' "$baseline" "$results"
@@ -0,0 +1,84 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   acpi.h                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/11 09:34:20 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/12 15:12:06 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef ACPI_H
+# define ACPI_H
+
+# include "types.h"
+
+// Le RSDP est cherche dans le premier Ko de l'EBDA, puis dans la ROM du BIOS
+# define ACPI_EBDA_POINTER		0x40E
+# define ACPI_BIOS_START		0xE0000
+# define ACPI_BIOS_END			0x100000
+
+typedef struct s_acpi_rsdp
+{
+	char	signature[8];		// "RSD PTR "
+	u8		checksum;
+	char	oem_id[6];
+	u8		revision;
+	u32		rsdt_address;
+}	__attribute__((packed)) t_acpi_rsdp;
+
+// En-tete commun a toutes les tables (RSDT, MADT...)
+typedef struct s_acpi_header
+{
+	char	signature[4];
+	u32		length;
+	u8		revision;
+	u8		checksum;
+	char	oem_id[6];
+	char	oem_table_id[8];
+	u32		oem_revision;
+	u32		creator_id;
+	u32		creator_revision;
+}	__attribute__((packed)) t_acpi_header;
+
+// MADT ("APIC"): adresse du LAPIC puis une suite d'entrees de taille variable
+typedef struct s_acpi_madt
+{
+	t_acpi_header	header;
+	u32				lapic_address;
+	u32				flags;
+}	__attribute__((packed)) t_acpi_madt;
+
+# define MADT_LOCAL_APIC			0
+# define MADT_LAPIC_OVERRIDE		5
+
+# define MADT_LAPIC_ENABLED			(1 << 0)
+
+typedef struct s_madt_entry
+{
+	u8	type;
+	u8	length;
+}	__attribute__((packed)) t_madt_entry;
+
+typedef struct s_madt_local_apic
+{
+	u8	type;
+	u8	length;
+	u8	acpi_id;
+	u8	apic_id;
+	u32	flags;
+}	__attribute__((packed)) t_madt_local_apic;
+
+typedef struct s_madt_lapic_override
+{
+	u8	type;
+	u8	length;
+	u16	reserved;
+	u64	address;
+}	__attribute__((packed)) t_madt_lapic_override;
+
+const t_acpi_header	*acpi_find_table(const char *signature);
+
+#endif
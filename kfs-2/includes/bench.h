@@ -0,0 +1,48 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/02 09:31:44 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/02 17:25:03 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BENCH_H
+# define BENCH_H
+
+# include "types.h"
+# include "stdbool.h"
+
+typedef struct s_bench
+{
+	const char	*name;
+	void		(*setup)(void);
+	void		(*run)(void);
+	void		(*teardown)(void);
+}	t_bench;
+
+// Comme SHELL_COMMAND: le cas atterrit dans la section .bench (linker.ld).
+// setup et teardown encadrent les BENCH_RUNS executions, hors mesure.
+# define BENCH_CASE(bench_name, bench_setup, bench_run, bench_teardown) \
+	static t_bench	bench_case_##bench_run \
+	__attribute__((used, section(".bench"), aligned(4))) = \
+	{bench_name, bench_setup, bench_run, bench_teardown}
+
+# define BENCH_RUNS			256
+# define BENCH_BUFFER_SIZE	4000
+
+typedef struct s_bench_result
+{
+	u32	min;
+	u32	median;
+	u32	p99;
+}	t_bench_result;
+
+void	bench_case(const t_bench *bench, t_bench_result *result);
+bool	bench_run(const char *name);
+void	bench_all(void);
+
+#endif
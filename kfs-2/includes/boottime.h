@@ -0,0 +1,24 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   boottime.h                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/06 09:12:48 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/06 14:37:20 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BOOTTIME_H
+# define BOOTTIME_H
+
+# include "types.h"
+
+# define BOOT_STAGES_MAX	16
+
+void	boot_stage(const char *name);
+u32		boot_total_kcycles(void);
+void	print_boot_stages(void);
+
+#endif
@@ -0,0 +1,35 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   console.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/26 09:41:12 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/26 15:20:44 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONSOLE_H
+# define CONSOLE_H
+
+# include "types.h"
+# include "stdbool.h"
+
+# define CONSOLE_MAX	4
+
+// Une sortie de printk: l'ecran VGA, le port serie...
+typedef struct s_console
+{
+	const char	*name;
+	void		(*write)(const char *data, size_t size);
+	bool		enabled;
+}	t_console;
+
+void	console_register(t_console *console);
+void	console_write(const char *data, size_t size);
+void	console_putchar(char c);
+bool	console_mute(bool mute);
+void	console_panic(void);
+
+#endif
@@ -0,0 +1,47 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   div64.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/25 10:04:51 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/25 10:31:07 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef DIV64_H
+# define DIV64_H
+
+# include "types.h"
+
+// Division 64 / 32 avec un seul divl, sans passer par __udivdi3 de libgcc.
+// Le quotient doit tenir sur 32 bits (high < divisor), sinon #DE.
+static __inline__
+u32	div64_32(u64 dividend, u32 divisor, u32 *remainder)
+{
+	u32	quotient;
+	u32	rem;
+
+	__asm__ ("divl %4"
+		: "=a"(quotient), "=d"(rem)
+		: "a"((u32)dividend), "d"((u32)(dividend >> 32)), "rm"(divisor));
+	if (remainder)
+		*remainder = rem;
+	return (quotient);
+}
+
+// Quotient 64 bits complet en deux divl: la partie haute d'abord, son reste
+// devient la partie haute de la seconde division, qui ne deborde plus
+static __inline__
+u64	div64(u64 dividend, u32 divisor)
+{
+	u32	high = dividend >> 32;
+	u32	rem;
+	u32	high_quotient = div64_32(high, divisor, &rem);
+
+	return (((u64)high_quotient << 32)
+		| div64_32(((u64)rem << 32) | (u32)dividend, divisor, NULL));
+}
+
+#endif
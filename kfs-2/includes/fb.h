@@ -0,0 +1,35 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fb.h                                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/09 11:20:14 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/10 17:03:41 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FB_H
+# define FB_H
+
+# include "types.h"
+# include "stdbool.h"
+# include "multiboot.h"
+
+// Police 8x8 doublee verticalement: une cellule texte fait 8x16 pixels
+# define FONT_WIDTH		8
+# define FONT_HEIGHT	16
+# define FONT_ROWS		8
+# define FONT_GLYPHS	128
+
+extern const u8	font_8x8[FONT_GLYPHS][FONT_ROWS];
+
+bool	fb_init(const t_multiboot2_tag_framebuffer *tag);
+bool	fb_enabled(void);
+size_t	fb_text_columns(void);
+size_t	fb_text_rows(void);
+void	fb_draw_cells(size_t x, size_t y, const u16 *cells, size_t len);
+void	fb_set_cursor(size_t row, size_t col);
+
+#endif
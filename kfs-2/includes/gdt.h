@@ -31,6 +31,19 @@ typedef struct s_gdt_ptr
 	u32	base;
 }	__attribute__((packed)) t_gdt_ptr;
 
+// TSS 32 bits: seuls ss0/esp0 (pile du noyau) et iomap_base servent
+typedef struct s_tss
+{
+	u32	prev_tss;
+	u32	esp0, ss0, esp1, ss1, esp2, ss2;
+	u32	cr3, eip, eflags;
+	u32	eax, ecx, edx, ebx, esp, ebp, esi, edi;
+	u32	es, cs, ss, ds, fs, gs;
+	u32	ldt;
+	u16	trap;
+	u16	iomap_base;
+}	__attribute__((packed)) t_tss;
+
 // Index des segments dans la GDT
 # define GDT_NULL_SEGMENT			0
 # define GDT_KERNEL_CODE_SEGMENT	1
@@ -40,7 +53,14 @@ typedef struct s_gdt_ptr
 # define GDT_USER_DATA_SEGMENT		5
 # define GDT_USER_STACK_SEGMENT		6
 
-# define GDT_ENTRIES_COUNT			7
+// Puis deux entrees par CPU: sa TSS et le segment de ses donnees (gs)
+# define GDT_CPU_SEGMENTS			7
+# define GDT_CPU_COUNT				8
+# define GDT_CPU_TSS(cpu)			(GDT_CPU_SEGMENTS + (cpu) * 2)
+# define GDT_CPU_DATA(cpu)			(GDT_CPU_SEGMENTS + (cpu) * 2 + 1)
+
+// linker.ld reserve GDT_ENTRIES_COUNT * 8 octets a GDT_BASE_ADRESS
+# define GDT_ENTRIES_COUNT			(GDT_CPU_SEGMENTS + GDT_CPU_COUNT * 2)
 
 # define GDT_BASE_ADRESS			0x00000800
 
@@ -102,9 +122,15 @@ typedef struct s_gdt_ptr
 // Flags pour segments 32 bits avec granularité 4KB
 # define GDT_FLAGS_32BIT				(GDT_GRANULARITY_4KB | GDT_32BIT)
 
+// Type systeme 0x9: TSS 32 bits disponible (le CPU le passe a 0xB avec ltr)
+# define GDT_TSS_AVAILABLE			0x9
+# define GDT_TSS_ACCESS				(GDT_PRESENT | GDT_RING_0 | GDT_SYSTEM_SEGMENT | GDT_TSS_AVAILABLE)
+
 
 void	gdt_set_gate(u32 num, u32 base, u32 limit, u8 access_byte, u8 flags);
 void	gdt_init(void);
+void	gdt_set_cpu(u32 cpu, t_tss *tss, u32 esp0, void *data, u32 size);
+void	gdt_load_cpu(u32 cpu);
 void	print_gdt(void);
 void	print_stack(void);
 
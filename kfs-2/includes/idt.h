@@ -0,0 +1,68 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   idt.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/24 14:02:11 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/24 18:37:45 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef IDT_H
+# define IDT_H
+
+# include "kernel.h"
+# include "gdt.h"
+
+typedef struct s_idt_entry
+{
+	u16	offset_low;
+	u16	selector;
+	u8	zero;
+	u8	type_attr;
+	u16	offset_high;
+}	__attribute__((packed)) t_idt_entry;
+
+typedef struct s_idt_ptr
+{
+	u16	limit;
+	u32	base;
+}	__attribute__((packed)) t_idt_ptr;
+
+// Etat pousse par isr_common (idt_stubs.s), dans l'ordre inverse des push
+typedef struct s_registers
+{
+	u32	gs, fs, es, ds;
+	u32	edi, esi, ebp, esp, ebx, edx, ecx, eax;
+	u32	int_no, err_code;
+	u32	eip, cs, eflags;
+}	t_registers;
+
+typedef void	(*t_isr_handler)(t_registers *regs);
+
+# define IDT_ENTRIES_COUNT			256
+
+# define IDT_KERNEL_CODE_SELECTOR	(GDT_KERNEL_CODE_SEGMENT << 3)
+
+// Present, ring 0, interrupt gate 32 bits
+# define IDT_INTERRUPT_GATE			0x8E
+
+// Les IRQ du PIC sont remappees juste apres les 32 exceptions du CPU
+# define IRQ_BASE					32
+# define IRQ_COUNT					16
+# define IRQ_TIMER					0
+# define IRQ_KEYBOARD				1
+# define IRQ_CASCADE				2
+
+# define EXCEPTION_PAGE_FAULT		14
+
+void	idt_set_gate(u8 num, u32 handler, u16 selector, u8 type_attr);
+void	idt_init(void);
+void	idt_load(void);
+void	isr_register_handler(u8 num, t_isr_handler handler);
+void	irq_register_handler(u8 irq, t_isr_handler handler);
+void	isr_handler(t_registers *regs);
+
+#endif
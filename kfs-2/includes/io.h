@@ -2,6 +2,7 @@
 # define IO_H
 
 #include "types.h"
+#include "stdbool.h"
 
 static __inline__
 void	outb(u16 port, u8 val)
@@ -25,4 +26,43 @@ void	outw(u16 port, u16 value)
 	__asm__ volatile ("outw %0, %1" : : "a"(value), "Nd"(port));
 }
 
+// Sauvegarde EFLAGS et coupe les interruptions, a restaurer avec irq_restore
+static __inline__
+u32	irq_save(void)
+{
+	u32	flags;
+
+	__asm__ volatile ("pushf; pop %0; cli" : "=r"(flags) : : "memory");
+
+	return (flags);
+}
+
+static __inline__
+void	irq_restore(u32 flags)
+{
+	if (flags & (1 << 9))
+		__asm__ volatile ("sti" : : : "memory");
+}
+
+static __inline__
+bool	irq_enabled(void)
+{
+	u32	flags;
+
+	__asm__ volatile ("pushf; pop %0" : "=r"(flags));
+
+	return (flags & (1 << 9));
+}
+
+static __inline__
+u64	rdtsc(void)
+{
+	u32	low;
+	u32	high;
+
+	__asm__ volatile ("rdtsc" : "=a"(low), "=d"(high));
+
+	return (((u64)high << 32) | low);
+}
+
 #endif
@@ -2,6 +2,7 @@
 # define KERNEL_H
 
 # include "types.h"
+# include "stdbool.h"
 
 #if defined(__LINUX__)
 #error "You are not using a cross-compiler, you will most certainly run into trouble"
@@ -11,11 +12,20 @@
 # define VGA_WIDTH		80
 # define VGA_HEIGHT		25
 # define VGA_MEMORY		0xB8000
+# define VGA_PAGE_CELLS	2048
+
+// Grille maximale, atteinte avec un framebuffer 1024x768 et des cellules 8x16
+# define TERM_MAX_COLS	128
+# define TERM_MAX_ROWS	48
 
 # define PROMPT_LENGTH	9
 
 # define INPUT_MAX		256
 
+// Historique circulaire par ecran, doit rester une puissance de 2
+# define SCROLLBACK_LINES	1024
+# define SCROLLBACK_MASK	(SCROLLBACK_LINES - 1)
+
 # define CTRL_PRESS		0x1D
 # define CTRL_RELEASE	0x9D
 # define KEY_C			0x2E
@@ -29,7 +39,11 @@
 # define ALT_RELEASE	0xB8
 # define LEFT_ARROW		0x4B
 # define RIGHT_ARROW	0x4D
-# define NUM_SCREENS	2
+# define PAGE_UP		0x49
+# define PAGE_DOWN		0x51
+# define EXTENDED_PREFIX	0xE0
+# define KEY_F1			0x3B
+# define NUM_SCREENS	8
 # define NEWLINE		'\n'
 # define BACKSPACE		'\b'
 # define ENTER			0x1C
@@ -56,27 +70,71 @@ enum vga_color
 
 typedef struct	s_screen
 {
-	size_t		save_row;
-	size_t		save_column;
-	size_t		save_input_end;
-	u8			save_color;
-	u16			save_buffer[VGA_WIDTH * VGA_HEIGHT];
+	size_t		row;
+	size_t		column;
+	size_t		input_end;
+	u8			color;
+	char		input_buffer[INPUT_MAX];
+	size_t		input_len;
+	u16			page_start;		// offset de la page VGA de l'ecran, en cellules
+	volatile u16	*page;
+	size_t		top;			// ligne de l'historique affichee en haut de l'ecran
+	size_t		history;		// lignes disponibles au-dessus de top
+	size_t		view_offset;	// lignes remontees avec Shift+PgUp
+	bool		painted;		// page VGA deja remplie depuis le boot
+	u16			lines[SCROLLBACK_LINES][TERM_MAX_COLS];
 }	t_screen;
 
+// Position de l'ecran courant, sauvee autour des mesures qui le font defiler
+typedef struct s_terminal_state
+{
+	size_t	screen;
+	size_t	row;
+	size_t	column;
+	size_t	top;
+	size_t	history;
+	size_t	view_offset;
+}	t_terminal_state;
+
+extern	size_t		current_screen;
+extern	size_t		term_cols;
+extern	size_t		term_rows;
+extern	u64			boot_tsc;
+
 extern	size_t		ft_strlen(const char *str);
+extern	char		*ft_strchrnul(const char *s, int c);
 extern	void		*ft_memcpy(void *dest, const void *src, size_t n);
-extern	void		ft_memset(void *s, int c, size_t n);	
+extern	void		*ft_memcpy_bytewise(void *dest, const void *src, size_t n);
+extern	void		*ft_memmove(void *dest, const void *src, size_t n);
+extern	void		ft_memset(void *s, int c, size_t n);
+extern	u16			*ft_memset16(u16 *s, u16 value, size_t count);
+extern	u32			*ft_memset32(u32 *s, u32 value, size_t count);
 
 // printk.c
 int		printk(const char *str, ...);
+char	*putnbr_base(char *end, unsigned long num, int base, int uppercase);
+char	*putnbr_dec(char *end, u32 num);
+char	*putnbr_hex(char *end, u32 num, int uppercase);
+char	*putnbr_dec64(char *end, u64 num);
+char	*putnbr_hex64(char *end, u64 num, int uppercase);
 
 // kernel.c
 void	terminal_initialize();
+void	terminal_set_framebuffer(size_t cols, size_t rows);
 void	terminal_set_color(u8 color);
+void	terminal_panic(void);
 void	set_cursor(u16 row, u16 col);
+void	terminal_sync_cursor(void);
+void	terminal_mark_dirty(size_t x, size_t y, size_t len);
+void	terminal_mark_dirty_all(void);
+void	terminal_flush(void);
 void	terminal_putentry(char c, u8 color, size_t x, size_t y);
 void	terminal_clear_screen(void);
 void	terminal_scroll();
+void	terminal_scroll_lines(size_t lines);
+void	terminal_scroll_view(int lines);
+void	terminal_save(t_terminal_state *state);
+void	terminal_restore(const t_terminal_state *state);
 void	terminal_putchar(char c);
 void	terminal_write(const char *data, size_t size);
 void	clear_line();
@@ -85,17 +143,13 @@ void	handle_backspace();
 void	handle_ctrl_l();
 void	handle_regular_char(char c);
 void	process_scancode(u8 scancode);
+void	handle_scancode(u8 scancode);
 void	handle_switch_terminal(u8 scancode);
 void	arrow_handler(u8 scancode);
 void	keyboard_handler_loop();
 void	terminal_write_string(const char *data);
 void	print_prompt();
-void	save_screen(size_t screen_id); 
-void	load_screen(size_t screen_id);
 void	switch_screen(size_t new_screen_id);
 void	draw_screen_index();
 
-// shell.c
-void	execute_command(const char *cmd);
-
 #endif
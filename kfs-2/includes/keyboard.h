@@ -0,0 +1,29 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   keyboard.h                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/24 15:11:50 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/24 18:37:45 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef KEYBOARD_H
+# define KEYBOARD_H
+
+# include "types.h"
+# include "stdbool.h"
+
+# define KEYBOARD_DATA_PORT		0x60
+# define KEYBOARD_STATUS_PORT	0x64
+
+// Taille de la file des scancodes: l'index u8 reboucle tout seul
+# define KEYBOARD_QUEUE_SIZE	256
+
+void	keyboard_init(void);
+bool	keyboard_pop(u8 *scancode);
+void	keyboard_wait(void);
+
+#endif
@@ -0,0 +1,53 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   kmalloc.h                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/29 09:47:05 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/29 18:12:40 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef KMALLOC_H
+# define KMALLOC_H
+
+# include "types.h"
+# include "paging.h"
+
+// Caches de 16 a 2048 octets (puissances de 2), une page de 4 Ko par slab
+# define KMALLOC_MIN_SHIFT		4
+# define KMALLOC_MAX_SHIFT		11
+# define KMALLOC_CACHES			(KMALLOC_MAX_SHIFT - KMALLOC_MIN_SHIFT + 1)
+# define KMALLOC_MAX_SLAB_SIZE	(1 << KMALLOC_MAX_SHIFT)
+
+// Au-dela, des pages de la zone a la demande, precedees d'un petit en-tete
+# define KMALLOC_LARGE_HEADER	16
+# define KMALLOC_RANGES_MAX		128
+
+# define ARENA_ALIGN			16
+# define COMMAND_ARENA_SIZE		(64 * 1024)
+
+typedef struct s_arena
+{
+	u8		*base;
+	size_t	size;
+	size_t	offset;
+	size_t	high_water;
+}	t_arena;
+
+extern t_arena	command_arena;
+
+void	kmalloc_init(void);
+void	*kmalloc(size_t size);
+void	*kzalloc(size_t size);
+void	kfree(void *ptr);
+
+bool	arena_init(t_arena *arena, size_t size);
+void	*arena_alloc(t_arena *arena, size_t size);
+void	arena_reset(t_arena *arena);
+
+void	print_heap(void);
+
+#endif
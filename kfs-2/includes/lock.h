@@ -0,0 +1,89 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lock.h                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/16 09:41:55 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/17 16:22:08 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOCK_H
+# define LOCK_H
+
+# include "types.h"
+# include "stdbool.h"
+
+# define LOCK_REGISTRY_MAX	32
+# define LOCK_TOP			10
+
+// Compteurs par verrou, mis a jour seulement avec KFS_LOCK_STATS (build
+// debug). Le verrou s'inscrit dans le registre a sa premiere prise.
+typedef struct s_lock_stats
+{
+	const char	*name;
+	u32			acquires;
+	u32			contended;
+	u64			wait_cycles;
+	u64			hold_cycles;
+	u64			locked_at;
+	bool		registered;
+}	t_lock_stats;
+
+# define LOCK_STATS_INIT(lock_name)	{(lock_name), 0, 0, 0, 0, 0, false}
+
+typedef struct s_spinlock
+{
+	volatile u32	locked;
+	t_lock_stats	stats;
+}	t_spinlock;
+
+// Ticket lock: servi dans l'ordre d'arrivee, pas de famine
+typedef struct s_ticketlock
+{
+	volatile u32	next;
+	volatile u32	serving;
+	t_lock_stats	stats;
+}	t_ticketlock;
+
+// Bit 31: un ecrivain tient le verrou ou attend la sortie des lecteurs,
+// les nouveaux lecteurs ne rentrent plus. Bits 0-30: lecteurs.
+# define RWLOCK_WRITER		(1u << 31)
+# define RWLOCK_READERS		(RWLOCK_WRITER - 1)
+
+typedef struct s_rwlock
+{
+	volatile u32	state;
+	t_lock_stats	stats;
+}	t_rwlock;
+
+# define SPINLOCK_INIT(name)	{0, LOCK_STATS_INIT(name)}
+# define TICKETLOCK_INIT(name)	{0, 0, LOCK_STATS_INIT(name)}
+# define RWLOCK_INIT(name)		{0, LOCK_STATS_INIT(name)}
+
+static __inline__
+void	cpu_relax(void)
+{
+	__asm__ volatile ("pause" : : : "memory");
+}
+
+bool	spin_trylock(t_spinlock *lock);
+void	spin_lock(t_spinlock *lock);
+void	spin_unlock(t_spinlock *lock);
+void	spin_force_unlock(t_spinlock *lock);
+u32		spin_lock_irqsave(t_spinlock *lock);
+void	spin_unlock_irqrestore(t_spinlock *lock, u32 flags);
+
+void	ticket_lock(t_ticketlock *lock);
+void	ticket_unlock(t_ticketlock *lock);
+u32		ticket_lock_irqsave(t_ticketlock *lock);
+void	ticket_unlock_irqrestore(t_ticketlock *lock, u32 flags);
+
+void	read_lock(t_rwlock *lock);
+void	read_unlock(t_rwlock *lock);
+void	write_lock(t_rwlock *lock);
+void	write_unlock(t_rwlock *lock);
+
+#endif
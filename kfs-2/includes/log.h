@@ -0,0 +1,58 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   log.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/18 10:07:31 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/18 17:45:12 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOG_H
+# define LOG_H
+
+# include "types.h"
+# include "stdbool.h"
+
+// Anneau du journal: LOG_SLOTS enregistrements de taille fixe,
+// doit rester une puissance de 2
+# define LOG_SLOTS			128
+# define LOG_MASK			(LOG_SLOTS - 1)
+# define LOG_RECORD_SIZE	256
+# define LOG_TEXT_MAX		(LOG_RECORD_SIZE - 16)
+// Nombre d'enregistrements reaffiches par dmesg
+# define LOG_DMESG			32
+
+// Niveaux, plus petit = plus grave
+# define LOG_ERR			3
+# define LOG_WARNING		4
+# define LOG_INFO			6
+# define LOG_DEBUG			7
+# define LOG_DEFAULT		LOG_INFO
+
+// A placer en tete du format: printk(KERN_ERR "...")
+# define KERN_SOH			"\001"
+# define KERN_ERR			KERN_SOH "3"
+# define KERN_WARNING		KERN_SOH "4"
+# define KERN_INFO			KERN_SOH "6"
+# define KERN_DEBUG			KERN_SOH "7"
+
+// commit vaut seq + 1 une fois le texte publie, 0 pendant l'ecriture
+typedef struct s_log_record
+{
+	volatile u32	commit;
+	u16				len;
+	u8				level;
+	u8				reserved;
+	u64				tsc;
+	char			text[LOG_TEXT_MAX];
+}	t_log_record;
+
+void	log_store(u8 level, const char *text, size_t len);
+void	log_drain(void);
+void	log_panic(void);
+u32		log_pending(void);
+
+#endif
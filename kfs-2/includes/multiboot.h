@@ -0,0 +1,113 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   multiboot.h                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/27 11:14:09 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/27 11:52:38 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MULTIBOOT_H
+# define MULTIBOOT_H
+
+# include "types.h"
+
+// Valeur laissee dans eax par un chargeur multiboot 1 (GRUB)
+# define MULTIBOOT_BOOTLOADER_MAGIC	0x2BADB002
+
+# define MULTIBOOT_INFO_MEMORY		(1 << 0)
+# define MULTIBOOT_INFO_MEM_MAP		(1 << 6)
+
+# define MULTIBOOT_MEMORY_AVAILABLE	1
+
+typedef struct s_multiboot_info
+{
+	u32	flags;
+	u32	mem_lower;		// Ko sous 1 Mo
+	u32	mem_upper;		// Ko au-dessus de 1 Mo
+	u32	boot_device;
+	u32	cmdline;
+	u32	mods_count;
+	u32	mods_addr;
+	u32	syms[4];
+	u32	mmap_length;
+	u32	mmap_addr;
+	u32	drives_length;
+	u32	drives_addr;
+	u32	config_table;
+	u32	boot_loader_name;
+	u32	apm_table;
+}	__attribute__((packed)) t_multiboot_info;
+
+// size ne compte pas son propre champ: l'entree suivante est a size + 4
+typedef struct s_multiboot_mmap_entry
+{
+	u32	size;
+	u64	addr;
+	u64	len;
+	u32	type;
+}	__attribute__((packed)) t_multiboot_mmap_entry;
+
+// Multiboot 2: eax vaut cette valeur, ebx pointe sur une suite de tags
+# define MULTIBOOT2_BOOTLOADER_MAGIC	0x36D76289
+
+# define MULTIBOOT2_TAG_END				0
+# define MULTIBOOT2_TAG_MMAP			6
+# define MULTIBOOT2_TAG_FRAMEBUFFER		8
+
+# define MULTIBOOT2_FRAMEBUFFER_RGB		1
+
+typedef struct s_multiboot2_info
+{
+	u32	total_size;
+	u32	reserved;
+}	t_multiboot2_info;
+
+// Chaque tag commence a une adresse multiple de 8
+typedef struct s_multiboot2_tag
+{
+	u32	type;
+	u32	size;
+}	t_multiboot2_tag;
+
+typedef struct s_multiboot2_mmap_entry
+{
+	u64	addr;
+	u64	len;
+	u32	type;
+	u32	reserved;
+}	__attribute__((packed)) t_multiboot2_mmap_entry;
+
+typedef struct s_multiboot2_tag_mmap
+{
+	u32	type;
+	u32	size;
+	u32	entry_size;
+	u32	entry_version;
+}	t_multiboot2_tag_mmap;
+
+typedef struct s_multiboot2_tag_framebuffer
+{
+	u32	type;
+	u32	size;
+	u64	addr;
+	u32	pitch;
+	u32	width;
+	u32	height;
+	u8	bpp;
+	u8	framebuffer_type;
+	u16	reserved;
+	u8	red_position;
+	u8	red_size;
+	u8	green_position;
+	u8	green_size;
+	u8	blue_position;
+	u8	blue_size;
+}	__attribute__((packed)) t_multiboot2_tag_framebuffer;
+
+const t_multiboot2_tag	*multiboot2_find_tag(const t_multiboot2_info *info, u32 type);
+
+#endif
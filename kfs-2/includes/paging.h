@@ -0,0 +1,75 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   paging.h                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/28 10:02:51 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/28 16:40:12 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PAGING_H
+# define PAGING_H
+
+# include "types.h"
+# include "stdbool.h"
+# include "pmm.h"
+
+# define PAGE_PRESENT			(1 << 0)
+# define PAGE_WRITE				(1 << 1)
+# define PAGE_USER				(1 << 2)
+# define PAGE_WRITE_THROUGH		(1 << 3)
+# define PAGE_CACHE_DISABLE		(1 << 4)
+# define PAGE_LARGE				(1 << 7)
+# define PAGE_GLOBAL			(1 << 8)
+
+# define PAGE_LARGE_SIZE		0x00400000
+# define PAGE_LARGE_SHIFT		22
+# define PAGE_ENTRIES			1024
+
+# define PAGE_FAULT_PRESENT		(1 << 0)
+# define PAGE_FAULT_WRITE		(1 << 1)
+
+# define CR0_PG					(1u << 31)
+# define CR0_WP					(1 << 16)
+# define CR4_PSE				(1 << 4)
+# define CR4_PGE				(1 << 7)
+
+# define CPUID_EDX_PSE			(1 << 3)
+# define CPUID_EDX_PGE			(1 << 13)
+
+// Zone reservee aux pages allouees a la demande: rien n'y est mappe
+// tant qu'on n'y touche pas, le page fault y met un frame rempli de zeros
+# define PAGING_DEMAND_START	0xD0000000
+# define PAGING_DEMAND_END		0xF0000000
+
+# define PAGE_ALIGN_DOWN(x)		((x) & ~(PAGE_SIZE - 1))
+# define PAGE_ALIGN_UP(x)		(((x) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+
+static __inline__
+void	invlpg(u32 addr)
+{
+	__asm__ volatile ("invlpg (%0)" : : "r"(addr) : "memory");
+}
+
+static __inline__
+u32	read_cr2(void)
+{
+	u32	value;
+
+	__asm__ volatile ("mov %%cr2, %0" : "=r"(value));
+
+	return (value);
+}
+
+void	paging_init(void);
+void	paging_identity_map(u32 start, u32 end);
+void	paging_identity_map_mmio(u32 start, u32 end);
+bool	paging_map_page(u32 virt, u32 phys, u32 flags);
+u32		paging_unmap_page(u32 virt);
+u32		paging_get_physical(u32 virt);
+void	print_paging(void);
+
+#endif
@@ -0,0 +1,38 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pic.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/24 14:20:37 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/24 16:03:12 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PIC_H
+# define PIC_H
+
+# include "types.h"
+
+# define PIC1_COMMAND	0x20
+# define PIC1_DATA		0x21
+# define PIC2_COMMAND	0xA0
+# define PIC2_DATA		0xA1
+
+# define PIC_EOI		0x20
+# define PIC_READ_IRR	0x0A
+# define PIC_READ_ISR	0x0B
+
+# define ICW1_INIT		0x10
+# define ICW1_ICW4		0x01
+# define ICW4_8086		0x01
+
+void	pic_remap(u8 master_offset, u8 slave_offset);
+void	pic_send_eoi(u8 irq);
+void	pic_mask_irq(u8 irq);
+void	pic_unmask_irq(u8 irq);
+u16		pic_get_irr(void);
+u16		pic_get_isr(void);
+
+#endif
@@ -0,0 +1,38 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pmm.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/27 11:20:51 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/27 17:06:13 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef PMM_H
+# define PMM_H
+
+# include "types.h"
+# include "stdbool.h"
+# include "multiboot.h"
+
+# define PAGE_SIZE			4096
+# define PAGE_SHIFT			12
+
+// 4 Go / 4 Ko: de quoi decrire tout l'espace physique 32 bits
+# define PMM_MAX_FRAMES		(1 << 20)
+
+# define PMM_LOW_MEMORY_END	0x00100000
+
+void	pmm_init(t_multiboot_info *mbi);
+void	pmm_init_multiboot2(const t_multiboot2_info *info);
+void	pmm_reserve_range(u32 start, u32 end);
+u32		pmm_alloc_frame(void);
+void	pmm_free_frame(u32 addr);
+u32		pmm_free_frames(void);
+u32		pmm_total_frames(void);
+u32		pmm_memory_end(void);
+void	print_memory(void);
+
+#endif
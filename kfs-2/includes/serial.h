@@ -0,0 +1,54 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   serial.h                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/26 10:05:18 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/26 15:20:44 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SERIAL_H
+# define SERIAL_H
+
+# include "types.h"
+# include "stdbool.h"
+
+# define COM1_PORT			0x3F8
+# define IRQ_COM1			4
+
+// Registres du 16550, en offset depuis le port de base
+# define SERIAL_DATA		0
+# define SERIAL_IER			1	// DLAB = 0
+# define SERIAL_DIVISOR_LOW	0	// DLAB = 1
+# define SERIAL_DIVISOR_HIGH	1	// DLAB = 1
+# define SERIAL_IIR			2	// lecture
+# define SERIAL_FCR			2	// ecriture
+# define SERIAL_LCR			3
+# define SERIAL_MCR			4
+# define SERIAL_LSR			5
+# define SERIAL_SCRATCH		7
+
+# define SERIAL_LCR_8N1		0x03
+# define SERIAL_LCR_DLAB	0x80
+// FIFO active, videe en RX et TX, seuil RX a 14 octets
+# define SERIAL_FCR_ENABLE	0xC7
+// DTR + RTS + OUT2 (OUT2 relie l'UART au PIC)
+# define SERIAL_MCR_IRQ		0x0B
+# define SERIAL_IER_THRE	0x02
+# define SERIAL_LSR_THRE	0x20
+
+# define SERIAL_FIFO_SIZE	16
+# define SERIAL_BAUD_DIVISOR	1	// 115200 bauds
+
+// Tampon d'emission logiciel, puissance de 2
+# define SERIAL_TX_SIZE		4096
+# define SERIAL_TX_MASK		(SERIAL_TX_SIZE - 1)
+
+bool	serial_init(void);
+void	serial_write(const char *data, size_t size);
+void	serial_flush(void);
+
+#endif
@@ -0,0 +1,42 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   shell.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/30 10:14:22 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/30 15:51:09 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SHELL_H
+# define SHELL_H
+
+# include "types.h"
+
+typedef void	(*t_command_handler)(const char *args);
+
+typedef struct s_command
+{
+	const char			*name;
+	const char			*usage;
+	const char			*help;
+	t_command_handler	handler;
+}	t_command;
+
+// Enregistre une commande dans la section .commands (voir linker.ld), depuis
+// n'importe quel fichier: shell_init la trie une fois, la recherche est
+// ensuite dichotomique quel que soit le nombre de commandes
+# define SHELL_COMMAND(cmd_name, cmd_usage, cmd_help, cmd_handler) \
+	static t_command	shell_command_##cmd_handler \
+	__attribute__((used, section(".commands"), aligned(4))) = \
+	{cmd_name, cmd_usage, cmd_help, cmd_handler}
+
+# define SHELL_USAGE_WIDTH	13
+
+int		ft_strncmp(const char *s1, const char *s2, size_t len);
+void	shell_init(void);
+void	execute_command(const char *cmd);
+
+#endif
@@ -0,0 +1,94 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   smp.h                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/11 11:02:47 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/13 17:48:30 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SMP_H
+# define SMP_H
+
+# include "types.h"
+# include "gdt.h"
+
+# define SMP_MAX_CPUS			GDT_CPU_COUNT
+# define SMP_STACK_SIZE			16384
+
+// Page du code de demarrage des APs: le SIPI demarre en real mode a vecteur << 12
+# define SMP_TRAMPOLINE			0x8000
+# define SMP_SIPI_VECTOR		(SMP_TRAMPOLINE >> 12)
+
+# define SMP_INIT_DELAY_MS		10
+# define SMP_SIPI_DELAY_US		200
+# define SMP_START_TIMEOUT_US	100000
+
+// Registres du LAPIC, en octets depuis sa base
+# define LAPIC_DEFAULT_BASE		0xFEE00000
+# define LAPIC_ID				0x020
+# define LAPIC_ESR				0x280
+# define LAPIC_SVR				0x0F0
+# define LAPIC_ICR_LOW			0x300
+# define LAPIC_ICR_HIGH			0x310
+
+# define LAPIC_SVR_ENABLE		(1 << 8)
+// Les 4 bits bas du vecteur parasite sont a 1 sur les anciens CPUs
+# define LAPIC_SPURIOUS_VECTOR	0xFF
+
+# define LAPIC_ICR_INIT			0x00000500
+# define LAPIC_ICR_STARTUP		0x00000600
+# define LAPIC_ICR_ASSERT		(1 << 14)
+# define LAPIC_ICR_PENDING		(1 << 12)
+
+enum cpu_state
+{
+	CPU_OFFLINE,
+	CPU_STARTING,
+	CPU_ONLINE,
+	CPU_FAILED,
+};
+
+// Zone par CPU, pointee par gs: this_cpu() lit self a l'offset 0.
+// Une ligne de cache par CPU au minimum, pas de faux partage.
+typedef struct s_cpu
+{
+	struct s_cpu	*self;
+	u32				index;
+	u32				apic_id;
+	volatile u32	state;
+	u32				stack_top;
+	u32				start_kcycles;	// du SIPI au passage online
+	t_tss			tss;
+}	__attribute__((aligned(64))) t_cpu;
+
+// Parametres lus par le trampoline (smp_trampoline.s), dans le meme ordre
+typedef struct s_trampoline_params
+{
+	t_gdt_ptr	gdt_ptr;
+	u16			padding;
+	u32			cr3;
+	u32			cr4;
+	u32			cr0;
+	u32			stack_top;
+	u32			entry;
+	u32			cpu;
+}	__attribute__((packed)) t_trampoline_params;
+
+static __inline__
+t_cpu	*this_cpu(void)
+{
+	t_cpu	*cpu;
+
+	__asm__ ("mov %%gs:0, %0" : "=r"(cpu));
+
+	return (cpu);
+}
+
+void	smp_init(void);
+u32		smp_cpu_count(void);
+
+#endif
@@ -0,0 +1,52 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   timer.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/25 10:02:16 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/25 16:48:30 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TIMER_H
+# define TIMER_H
+
+# include "types.h"
+# include "stdbool.h"
+
+# define PIT_FREQUENCY		1193182
+# define PIT_CHANNEL0		0x40
+# define PIT_COMMAND		0x43
+
+// Canal 0, octet bas puis haut, mode 0 (interruption en fin de comptage)
+# define PIT_MODE_ONESHOT	0x30
+# define PIT_LATCH_CH0		0x00
+
+# define PIT_MAX_COUNT		0xFFFF
+// En dessous, on laisse l'echeance tomber au prochain IRQ plutot que de
+// se faire interrompre en boucle
+# define PIT_MIN_COUNT		32
+
+# define TIMER_MAX			32
+
+typedef void	(*t_timer_callback)(void *arg);
+
+typedef struct s_timer
+{
+	u64					deadline;	// en ticks PIT
+	t_timer_callback	callback;
+	void				*arg;
+}	t_timer;
+
+void	timer_init(void);
+u64		timer_now_ticks(void);
+u64		timer_now_us(void);
+u64		timer_ticks_to_us(u64 ticks);
+u64		timer_us_to_ticks(u64 us);
+bool	timer_add(u64 delay_us, t_timer_callback callback, void *arg);
+void	timer_sleep_us(u64 us);
+void	timer_sleep_ms(u32 ms);
+
+#endif
@@ -0,0 +1,58 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   trace.h                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/04 10:20:37 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/04 18:02:11 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TRACE_H
+# define TRACE_H
+
+# include "types.h"
+
+enum trace_id
+{
+	TRACE_NONE,
+	TRACE_KEYBOARD_IRQ,
+	TRACE_SCANCODE_BEGIN,
+	TRACE_SCANCODE_END,
+	TRACE_PUTCHAR,
+	TRACE_FLUSH_BEGIN,
+	TRACE_FLUSH_END,
+	TRACE_CURSOR,
+	TRACE_SCROLL,
+	TRACE_SWITCH,
+	TRACE_COMMAND_BEGIN,
+	TRACE_COMMAND_END,
+	TRACE_ID_COUNT,
+};
+
+typedef struct s_trace_event
+{
+	u64	tsc;
+	u32	id;
+	u32	arg0;
+	u32	arg1;
+}	t_trace_event;
+
+// Puissance de 2: l'index tourne avec un masque
+# define TRACE_EVENTS		4096
+# define TRACE_MASK			(TRACE_EVENTS - 1)
+# define TRACE_DUMP_EVENTS	32
+
+// Sans KFS_TRACE (build release, make bench), les points de trace
+// disparaissent a la compilation, arguments compris
+# ifdef KFS_TRACE
+#  define TRACE(id, arg0, arg1)	trace_record(id, (u32)(arg0), (u32)(arg1))
+# else
+#  define TRACE(id, arg0, arg1)	((void)0)
+# endif
+
+void	trace_record(u32 id, u32 arg0, u32 arg1);
+
+#endif
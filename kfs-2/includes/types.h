@@ -4,12 +4,14 @@
 typedef	unsigned char		u8;
 typedef unsigned short		u16;
 typedef unsigned int		u32;
+typedef unsigned long long	u64;
 
 typedef unsigned int		size_t;
 
 typedef char		i8;
 typedef short		i16;
 typedef int			i32;
+typedef long long	i64;
 
 # define	NULL	(void *)0
 
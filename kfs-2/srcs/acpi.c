@@ -0,0 +1,97 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   acpi.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/11 09:34:20 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/12 15:12:06 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/acpi.h"
+#include "../includes/kernel.h"
+#include "../includes/stdbool.h"
+#include "../includes/paging.h"
+#include "../includes/shell.h"
+
+static bool	checksum_ok(const void *data, u32 len)
+{
+	const u8	*bytes = data;
+	u8			sum = 0;
+
+	for (u32 index = 0; index < len; ++index)
+		sum += bytes[index];
+	return (sum == 0);
+}
+
+static const t_acpi_rsdp	*find_rsdp_in(u32 start, u32 end)
+{
+	for (u32 addr = start; addr + sizeof(t_acpi_rsdp) <= end; addr += 16)
+	{
+		const t_acpi_rsdp	*rsdp = (const t_acpi_rsdp *)addr;
+
+		if (ft_strncmp(rsdp->signature, "RSD PTR ", 8) == 0
+			&& checksum_ok(rsdp, sizeof(t_acpi_rsdp)))
+			return (rsdp);
+	}
+	return (NULL);
+}
+
+static const t_acpi_rsdp	*find_rsdp(void)
+{
+	u32					ebda;
+	const t_acpi_rsdp	*rsdp = NULL;
+
+	// Lu en asm: gcc -O2 prend une adresse sous 4 Ko pour un pointeur nul decale
+	__asm__ volatile ("movzwl (%1), %0" : "=r"(ebda) : "r"(ACPI_EBDA_POINTER));
+	ebda <<= 4;
+	if (ebda)
+		rsdp = find_rsdp_in(ebda, ebda + 1024);
+	if (!rsdp)
+		rsdp = find_rsdp_in(ACPI_BIOS_START, ACPI_BIOS_END);
+	return (rsdp);
+}
+
+// Les tables sont en haut de la RAM, souvent au-dela de ce que le pmm
+// annonce comme utilisable: on les mappe avant de les lire.
+// Rien au-dessus de la zone a la demande, qui ne doit pas etre mappee.
+static const t_acpi_header	*map_table(u32 addr)
+{
+	const t_acpi_header	*table = (const t_acpi_header *)addr;
+
+	if (addr + sizeof(t_acpi_header) > PAGING_DEMAND_START)
+		return (NULL);
+	paging_identity_map(addr, addr + sizeof(t_acpi_header));
+	if (table->length < sizeof(t_acpi_header)
+		|| table->length > PAGING_DEMAND_START - addr)
+		return (NULL);
+	paging_identity_map(addr, addr + table->length);
+	if (!checksum_ok(table, table->length))
+		return (NULL);
+	return (table);
+}
+
+// Table ACPI 1.0 par signature ("APIC" pour la MADT), via la RSDT
+const t_acpi_header	*acpi_find_table(const char *signature)
+{
+	const t_acpi_rsdp	*rsdp = find_rsdp();
+	const t_acpi_header	*rsdt;
+	const u32			*entries;
+	u32					count;
+
+	if (!rsdp || !(rsdt = map_table(rsdp->rsdt_address))
+		|| ft_strncmp(rsdt->signature, "RSDT", 4) != 0)
+		return (NULL);
+	entries = (const u32 *)(rsdt + 1);
+	count = (rsdt->length - sizeof(t_acpi_header)) / sizeof(u32);
+	for (u32 index = 0; index < count; ++index)
+	{
+		const t_acpi_header	*table = map_table(entries[index]);
+
+		if (table && ft_strncmp(table->signature, signature, 4) == 0)
+			return (table);
+	}
+	return (NULL);
+}
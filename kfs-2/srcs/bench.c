@@ -0,0 +1,323 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/02 09:32:10 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/02 17:25:03 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/bench.h"
+#include "../includes/kernel.h"
+#include "../includes/io.h"
+#include "../includes/console.h"
+#include "../includes/kmalloc.h"
+#include "../includes/log.h"
+#include "../includes/shell.h"
+
+extern t_bench	__bench_start[];
+extern t_bench	__bench_end[];
+
+static u8		bench_src[BENCH_BUFFER_SIZE + 16] __attribute__((aligned(16)));
+static u8		bench_dest[BENCH_BUFFER_SIZE + 16] __attribute__((aligned(16)));
+static u32		samples[BENCH_RUNS];
+
+static bool		has_rdtscp = false;
+static u32		overhead = 0xFFFFFFFF;
+
+static void	cpuid(u32 leaf, u32 *eax, u32 *edx)
+{
+	u32	ebx;
+	u32	ecx;
+
+	__asm__ volatile ("cpuid" : "=a"(*eax), "=b"(ebx), "=c"(ecx), "=d"(*edx) : "a"(leaf), "c"(0));
+}
+
+// cpuid serialise: rien de ce qui precede ne deborde dans la mesure
+static __inline__ u64	bench_start(void)
+{
+	u32	low;
+	u32	high;
+
+	__asm__ volatile ("cpuid; rdtsc" : "=a"(low), "=d"(high) : "a"(0) : "ebx", "ecx", "memory");
+	return (((u64)high << 32) | low);
+}
+
+// rdtscp attend la fin du code mesure, le cpuid suivant empeche la suite
+// de remonter avant la lecture. Sans rdtscp, cpuid avant rdtsc.
+static __inline__ u64	bench_stop(void)
+{
+	u32	low;
+	u32	high;
+
+	if (has_rdtscp)
+		__asm__ volatile ("rdtscp; mov %%eax, %0; mov %%edx, %1; xor %%eax, %%eax; cpuid"
+			: "=r"(low), "=r"(high) : : "eax", "ebx", "ecx", "edx", "memory");
+	else
+		__asm__ volatile ("cpuid; rdtsc" : "=a"(low), "=d"(high) : "a"(0) : "ebx", "ecx", "memory");
+	return (((u64)high << 32) | low);
+}
+
+static void	bench_empty(void)
+{
+}
+
+// Cout des deux lectures seules, retire de chaque echantillon
+static void	bench_calibrate(void)
+{
+	u32	eax;
+	u32	edx;
+
+	cpuid(0x80000000, &eax, &edx);
+	if (eax >= 0x80000001)
+	{
+		cpuid(0x80000001, &eax, &edx);
+		has_rdtscp = (edx & (1 << 27)) != 0;
+	}
+	for (u32 run = 0; run < BENCH_RUNS; ++run)
+	{
+		u32	flags = irq_save();
+		u64	start = bench_start();
+		bench_empty();
+		u32	cycles = (u32)(bench_stop() - start);
+		irq_restore(flags);
+
+		if (cycles < overhead)
+			overhead = cycles;
+	}
+}
+
+static void	sort_samples(u32 *values, u32 count)
+{
+	for (u32 index = 1; index < count; ++index)
+	{
+		u32	value = values[index];
+		u32	pos = index;
+
+		while (pos > 0 && values[pos - 1] > value)
+		{
+			values[pos] = values[pos - 1];
+			--pos;
+		}
+		values[pos] = value;
+	}
+}
+
+void	bench_case(const t_bench *bench, t_bench_result *result)
+{
+	if (overhead == 0xFFFFFFFF)
+		bench_calibrate();
+	if (bench->setup)
+		bench->setup();
+
+	for (u32 run = 0; run < BENCH_RUNS; ++run)
+	{
+		// Pas d'IRQ au milieu d'un echantillon
+		u32	flags = irq_save();
+		u64	start = bench_start();
+		bench->run();
+		u32	cycles = (u32)(bench_stop() - start);
+		irq_restore(flags);
+
+		samples[run] = cycles > overhead ? cycles - overhead : 0;
+	}
+	if (bench->teardown)
+		bench->teardown();
+	sort_samples(samples, BENCH_RUNS);
+	result->min = samples[0];
+	result->median = samples[BENCH_RUNS / 2];
+	result->p99 = samples[BENCH_RUNS * 99 / 100];
+}
+
+// Une ligne par cas, facile a extraire du port serie d'un build a l'autre
+static void	bench_report(const t_bench *bench)
+{
+	t_bench_result	result;
+
+	bench_case(bench, &result);
+	printk("BENCH name=%s runs=%u min=%u median=%u p99=%u\n",
+		bench->name, BENCH_RUNS, result.min, result.median, result.p99);
+	// Rendue tout de suite: scroll et switch ne la dessinent pas pendant leurs mesures
+	log_drain();
+}
+
+bool	bench_run(const char *name)
+{
+	size_t	len = ft_strlen(name);
+
+	for (t_bench *bench = __bench_start; bench < __bench_end; ++bench)
+	{
+		if (ft_strncmp(bench->name, name, len + 1) == 0)
+		{
+			bench_report(bench);
+			return (true);
+		}
+	}
+	return (false);
+}
+
+void	bench_all(void)
+{
+	for (t_bench *bench = __bench_start; bench < __bench_end; ++bench)
+		bench_report(bench);
+}
+
+static void	command_bench(const char *args)
+{
+	terminal_set_color(VGA_COLOR_WHITE);
+	if (!*args)
+	{
+		printk("bench all | bench <case>, cases:");
+		for (t_bench *bench = __bench_start; bench < __bench_end; ++bench)
+			printk(" %s", bench->name);
+		printk("\n");
+	}
+	else if (ft_strncmp(args, "all", 4) == 0)
+		bench_all();
+	else if (!bench_run(args))
+		printk("bench: unknown case '%s'\n", args);
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+SHELL_COMMAND("bench", "bench <case>", "cycle counts (min/median/p99)", command_bench);
+
+// Cas de mesure: un ecran VGA complet (80x25 cellules) pour les copies
+
+static void	bench_memcpy(void)
+{
+	ft_memcpy(bench_dest, bench_src, BENCH_BUFFER_SIZE);
+}
+
+static void	bench_memcpy_unaligned(void)
+{
+	ft_memcpy(bench_dest + 1, bench_src + 3, BENCH_BUFFER_SIZE);
+}
+
+static void	bench_memcpy_bytewise(void)
+{
+	ft_memcpy_bytewise(bench_dest, bench_src, BENCH_BUFFER_SIZE);
+}
+
+// Recouvrement: le chemin arriere de ft_memmove
+static void	bench_memmove(void)
+{
+	ft_memmove(bench_dest + 8, bench_dest, BENCH_BUFFER_SIZE);
+}
+
+static void	bench_memset(void)
+{
+	ft_memset(bench_dest, 0, BENCH_BUFFER_SIZE);
+}
+
+static void	bench_strlen_setup(void)
+{
+	ft_memset(bench_src, 'a', 255);
+	bench_src[255] = '\0';
+}
+
+static void	bench_strlen(void)
+{
+	__asm__ volatile ("" : : "r"(ft_strlen((const char *)bench_src)));
+}
+
+// Les lignes BENCH deja journalisees partent avant que les consoles soient coupees
+static void	bench_printk_setup(void)
+{
+	log_drain();
+}
+
+// Mise en forme, passage par le journal et aiguillage vers les sorties,
+// sans l'affichage lui-meme
+static void	bench_printk(void)
+{
+	bool	previous = console_mute(true);
+
+	printk("%s %d 0x%x\n", "bench", -42, 0xBEEF);
+	log_drain();
+	console_mute(previous);
+}
+
+// Conversion seule. format_base fait les deux bases avec l'ancien putnbr_base:
+// a comparer a format_dec + format_hex.
+// volatile: la valeur n'est pas connue a la compilation
+static volatile u32	bench_number = 0xDEADBEEF;
+
+static void	bench_format_base(void)
+{
+	char	digits[32];
+
+	__asm__ volatile ("" : : "r"(putnbr_base(digits + 32, bench_number, 10, 0)) : "memory");
+	__asm__ volatile ("" : : "r"(putnbr_base(digits + 32, bench_number, 16, 0)) : "memory");
+}
+
+static void	bench_format_dec(void)
+{
+	char	digits[32];
+
+	__asm__ volatile ("" : : "r"(putnbr_dec(digits + 32, bench_number)) : "memory");
+}
+
+static void	bench_format_hex(void)
+{
+	char	digits[32];
+
+	__asm__ volatile ("" : : "r"(putnbr_hex(digits + 32, bench_number, 0)) : "memory");
+}
+
+static void	bench_format_dec64(void)
+{
+	char	digits[32];
+
+	__asm__ volatile ("" : : "r"(putnbr_dec64(digits + 32, (u64)bench_number * bench_number)) : "memory");
+}
+
+// scroll et switch tournent sur la session en cours: sa position et son
+// ecran sont remis en place une fois les mesures faites
+static t_terminal_state	bench_terminal;
+
+static void	bench_terminal_save(void)
+{
+	terminal_save(&bench_terminal);
+}
+
+static void	bench_terminal_restore(void)
+{
+	terminal_restore(&bench_terminal);
+}
+
+static void	bench_scroll(void)
+{
+	terminal_scroll_lines(1);
+	terminal_flush();
+}
+
+static void	bench_switch(void)
+{
+	size_t	screen = current_screen;
+
+	switch_screen((screen + 1) % NUM_SCREENS);
+	switch_screen(screen);
+}
+
+static void	bench_kmalloc(void)
+{
+	kfree(kmalloc(64));
+}
+
+BENCH_CASE("memcpy", NULL, bench_memcpy, NULL);
+BENCH_CASE("memcpy_unaligned", NULL, bench_memcpy_unaligned, NULL);
+BENCH_CASE("memcpy_bytewise", NULL, bench_memcpy_bytewise, NULL);
+BENCH_CASE("memmove", NULL, bench_memmove, NULL);
+BENCH_CASE("memset", NULL, bench_memset, NULL);
+BENCH_CASE("strlen", bench_strlen_setup, bench_strlen, NULL);
+BENCH_CASE("printk", bench_printk_setup, bench_printk, NULL);
+BENCH_CASE("format_base", NULL, bench_format_base, NULL);
+BENCH_CASE("format_dec", NULL, bench_format_dec, NULL);
+BENCH_CASE("format_hex", NULL, bench_format_hex, NULL);
+BENCH_CASE("format_dec64", NULL, bench_format_dec64, NULL);
+BENCH_CASE("scroll", bench_terminal_save, bench_scroll, bench_terminal_restore);
+BENCH_CASE("switch", bench_terminal_save, bench_switch, bench_terminal_restore);
+BENCH_CASE("kmalloc", NULL, bench_kmalloc, NULL);
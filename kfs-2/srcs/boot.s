@@ -8,25 +8,94 @@ extern kernel_main
 %define MAGIC      0x1BADB002
 %define CHECKSUM   -(MAGIC + FLAGS)
 
+; Multiboot 2: meme noyau, GRUB choisit selon la commande de grub.cfg
+%define MB2_MAGIC  0xE85250D6
+%define MB2_ARCH   0
+%define MB2_LENGTH (mb2_header_end - mb2_header)
+
 section .multiboot
 align 4
     dd MAGIC
     dd FLAGS
     dd CHECKSUM
 
+align 8
+mb2_header:
+    dd MB2_MAGIC
+    dd MB2_ARCH
+    dd MB2_LENGTH
+    dd 0x100000000 - (MB2_MAGIC + MB2_ARCH + MB2_LENGTH)
+
+; Tag framebuffer, optionnel: sans mode graphique on reste en texte VGA
+align 8
+    dw 5
+    dw 1
+    dd 20
+    dd 1024
+    dd 768
+    dd 32
+
+align 8
+    dw 0
+    dw 0
+    dd 8
+mb2_header_end:
+
+section .data
+align 4
+global cpu_has_sse2
+cpu_has_sse2:
+    dd 0
+
+; TSC a l'entree du noyau, origine des mesures de duree du boot
+global boot_tsc
+align 8
+boot_tsc:
+    dq 0
+
 section .bss
 align 16
 stack_bottom:
     resb 16384
+; Pile du BSP, reprise comme esp0 de sa TSS par smp_init
+global stack_top
 stack_top:
 
 section .text
 global _start
 _start:
+    mov		edi, eax
+    rdtsc
+    mov		[boot_tsc], eax
+    mov		[boot_tsc + 4], edx
     mov		esp, stack_top
+    mov		esi, ebx
+    call	enable_sse
+    push	esi
+    push	edi
     call	kernel_main
 	cli
 
 .hang:
     hlt
 	jmp .hang
+
+; Active SSE (CR0.EM = 0, CR0.MP = 1, CR4.OSFXSR | CR4.OSXMMEXCPT)
+; si cpuid annonce SSE2, et le note dans cpu_has_sse2.
+enable_sse:
+    mov		eax, 1
+    cpuid
+    test	edx, (1 << 26)
+    jz		.no_sse2
+
+    mov		eax, cr0
+    and		eax, ~(1 << 2)
+    or		eax, (1 << 1)
+    mov		cr0, eax
+    mov		eax, cr4
+    or		eax, (1 << 9) | (1 << 10)
+    mov		cr4, eax
+    mov		dword [cpu_has_sse2], 1
+
+.no_sse2:
+    ret
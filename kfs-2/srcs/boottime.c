@@ -0,0 +1,76 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   boottime.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/06 09:13:05 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/06 14:37:20 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/boottime.h"
+#include "../includes/kernel.h"
+#include "../includes/io.h"
+#include "../includes/div64.h"
+#include "../includes/shell.h"
+
+typedef struct s_boot_stage
+{
+	const char	*name;
+	u64			tsc;
+}	t_boot_stage;
+
+static t_boot_stage	stages[BOOT_STAGES_MAX];
+static u32			stage_count = 0;
+
+// Fin d'une etape du boot: sa duree court depuis la precedente, ou depuis
+// l'entree dans _start (boot_tsc) pour la premiere
+void	boot_stage(const char *name)
+{
+	if (stage_count == BOOT_STAGES_MAX)
+		return ;
+	stages[stage_count].name = name;
+	stages[stage_count].tsc = rdtsc();
+	++stage_count;
+}
+
+u32	boot_total_kcycles(void)
+{
+	if (!stage_count)
+		return (0);
+	return (div64_32(stages[stage_count - 1].tsc - boot_tsc, 1000, NULL));
+}
+
+void	print_boot_stages(void)
+{
+	u64	previous = boot_tsc;
+
+	for (u32 index = 0; index < stage_count; ++index)
+	{
+#ifdef BENCH_MODE
+		printk("BOOT stage=%s kcycles=%u\n", stages[index].name,
+			div64_32(stages[index].tsc - previous, 1000, NULL));
+#else
+		printk("%-*s%u kcycles\n", SHELL_USAGE_WIDTH, stages[index].name,
+			div64_32(stages[index].tsc - previous, 1000, NULL));
+#endif
+		previous = stages[index].tsc;
+	}
+#ifdef BENCH_MODE
+	printk("BOOT kcycles=%u\n", boot_total_kcycles());
+#else
+	printk("total        %u kcycles to the first prompt\n", boot_total_kcycles());
+#endif
+}
+
+static void	command_boot(const char *args)
+{
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	print_boot_stages();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+SHELL_COMMAND("boot", "boot", "cycles spent in each boot stage", command_boot);
@@ -0,0 +1,63 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   console.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/26 09:42:30 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/26 15:20:44 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/console.h"
+#include "../includes/lock.h"
+
+static t_console	*consoles[CONSOLE_MAX];
+static size_t		console_count = 0;
+static bool			muted = false;
+// Un message entier passe par toutes les sorties avant le suivant
+static t_spinlock	console_lock = SPINLOCK_INIT("console");
+
+void	console_register(t_console *console)
+{
+	if (console_count == CONSOLE_MAX)
+		return ;
+	console->enabled = true;
+	consoles[console_count++] = console;
+}
+
+// Les memes octets formates partent vers chaque sortie active
+void	console_write(const char *data, size_t size)
+{
+	u32	flags;
+
+	if (!size || muted)
+		return ;
+	flags = spin_lock_irqsave(&console_lock);
+	for (size_t index = 0; index < console_count; ++index)
+		if (consoles[index]->enabled)
+			consoles[index]->write(data, size);
+	spin_unlock_irqrestore(&console_lock, flags);
+}
+
+// Avant un message fatal: la faute a pu tomber au milieu d'un console_write
+void	console_panic(void)
+{
+	spin_force_unlock(&console_lock);
+	muted = false;
+}
+
+void	console_putchar(char c)
+{
+	console_write(&c, 1);
+}
+
+// Coupe toutes les sorties (mesures de printk sans l'affichage), renvoie l'etat precedent
+bool	console_mute(bool mute)
+{
+	bool	previous = muted;
+
+	muted = mute;
+	return (previous);
+}
@@ -0,0 +1,184 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   fb.c                                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/09 11:20:14 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/10 17:03:41 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/fb.h"
+#include "../includes/kernel.h"
+#include "../includes/paging.h"
+
+static volatile u8	*fb_base = NULL;
+static u32			fb_pitch;		// octets par ligne de pixels
+static size_t		text_cols;
+static size_t		text_rows;
+static u32			palette[16];
+
+// Pixels 32 bits d'un demi-octet de glyphe pour l'attribut courant:
+// une ligne de glyphe se pose en 8 stores de dwords, sans test par pixel
+static u32			nibble_pixels[16][4];
+static u16			nibble_attr = 0xFFFF;
+
+// Ce qui est affiche: une cellule inchangee n'est pas redessinee
+static u16			shadow[TERM_MAX_ROWS][TERM_MAX_COLS];
+
+static size_t		cursor_row = TERM_MAX_ROWS;
+static size_t		cursor_col = 0;
+
+static const u8	vga_palette[16][3] = {
+	{0x00, 0x00, 0x00}, {0x00, 0x00, 0xAA}, {0x00, 0xAA, 0x00}, {0x00, 0xAA, 0xAA},
+	{0xAA, 0x00, 0x00}, {0xAA, 0x00, 0xAA}, {0xAA, 0x55, 0x00}, {0xAA, 0xAA, 0xAA},
+	{0x55, 0x55, 0x55}, {0x55, 0x55, 0xFF}, {0x55, 0xFF, 0x55}, {0x55, 0xFF, 0xFF},
+	{0xFF, 0x55, 0x55}, {0xFF, 0x55, 0xFF}, {0xFF, 0xFF, 0x55}, {0xFF, 0xFF, 0xFF},
+};
+
+static inline u32	color_channel(u8 value, u8 position, u8 size)
+{
+	return ((u32)(value >> (8 - size)) << position);
+}
+
+static void	set_colors(u8 attr)
+{
+	u32	fg = palette[attr & 0x0F];
+	u32	bg = palette[attr >> 4];
+
+	for (size_t nibble = 0; nibble < 16; ++nibble)
+		for (size_t i = 0; i < 4; ++i)
+			nibble_pixels[nibble][i] = (nibble & (8 >> i)) ? fg : bg;
+	nibble_attr = attr;
+}
+
+static inline volatile u32	*cell_pixels(size_t x, size_t y)
+{
+	return ((volatile u32 *)(fb_base + y * FONT_HEIGHT * fb_pitch) + x * FONT_WIDTH);
+}
+
+// Chaque ligne de la police est posee deux fois (cellule 8x16)
+static void	draw_cell(size_t x, size_t y, u16 cell)
+{
+	u8				c = cell & 0xFF;
+	const u8		*glyph = font_8x8[c < FONT_GLYPHS ? c : 0];
+	volatile u32	*dst = cell_pixels(x, y);
+	size_t			stride = fb_pitch / sizeof(u32);
+
+	if ((cell >> 8) != nibble_attr)
+		set_colors(cell >> 8);
+	for (size_t row = 0; row < FONT_ROWS; ++row)
+	{
+		const u32	*left = nibble_pixels[glyph[row] >> 4];
+		const u32	*right = nibble_pixels[glyph[row] & 0x0F];
+
+		for (size_t twice = 0; twice < 2; ++twice)
+		{
+			for (size_t i = 0; i < 4; ++i)
+			{
+				dst[i] = left[i];
+				dst[i + 4] = right[i];
+			}
+			dst += stride;
+		}
+	}
+}
+
+// Curseur logiciel: soulignement sur les deux dernieres lignes de la cellule
+static void	draw_cursor(void)
+{
+	u32				color = palette[(shadow[cursor_row][cursor_col] >> 8) & 0x0F];
+	volatile u32	*dst = cell_pixels(cursor_col, cursor_row);
+	size_t			stride = fb_pitch / sizeof(u32);
+
+	dst += (FONT_HEIGHT - 2) * stride;
+	for (size_t row = 0; row < 2; ++row)
+	{
+		for (size_t i = 0; i < FONT_WIDTH; ++i)
+			dst[i] = color;
+		dst += stride;
+	}
+}
+
+// Mode 32 bits RGB uniquement; renvoie false pour rester en texte VGA
+bool	fb_init(const t_multiboot2_tag_framebuffer *tag)
+{
+	u64	size;
+
+	if (!tag || tag->framebuffer_type != MULTIBOOT2_FRAMEBUFFER_RGB || tag->bpp != 32)
+		return (false);
+	if (tag->width < VGA_WIDTH * FONT_WIDTH || tag->height < VGA_HEIGHT * FONT_HEIGHT)
+		return (false);
+	size = (u64)tag->pitch * tag->height;
+	if (tag->addr + size > 0x100000000ULL)
+		return (false);
+	// Un fault dans la zone a la demande y mettrait un frame neuf
+	if (tag->addr < PAGING_DEMAND_END && tag->addr + size > PAGING_DEMAND_START)
+		return (false);
+
+	paging_identity_map((u32)tag->addr, (u32)(tag->addr + size));
+	fb_base = (volatile u8 *)(u32)tag->addr;
+	fb_pitch = tag->pitch;
+	text_cols = tag->width / FONT_WIDTH;
+	text_rows = tag->height / FONT_HEIGHT;
+	if (text_cols > TERM_MAX_COLS)
+		text_cols = TERM_MAX_COLS;
+	if (text_rows > TERM_MAX_ROWS)
+		text_rows = TERM_MAX_ROWS;
+
+	for (size_t i = 0; i < 16; ++i)
+		palette[i] = color_channel(vga_palette[i][0], tag->red_position, tag->red_size)
+			| color_channel(vga_palette[i][1], tag->green_position, tag->green_size)
+			| color_channel(vga_palette[i][2], tag->blue_position, tag->blue_size);
+
+	// Ecran noir: correspond a shadow, encore a zero
+	ft_memset32((u32 *)fb_base, 0, size / sizeof(u32));
+	return (true);
+}
+
+bool	fb_enabled(void)
+{
+	return (fb_base != NULL);
+}
+
+size_t	fb_text_columns(void)
+{
+	return (text_cols);
+}
+
+size_t	fb_text_rows(void)
+{
+	return (text_rows);
+}
+
+void	fb_draw_cells(size_t x, size_t y, const u16 *cells, size_t len)
+{
+	u16	*shown = &shadow[y][x];
+
+	for (size_t i = 0; i < len; ++i)
+	{
+		if (shown[i] == cells[i])
+			continue ;
+		shown[i] = cells[i];
+		draw_cell(x + i, y, cells[i]);
+	}
+	if (y == cursor_row && cursor_col >= x && cursor_col < x + len)
+		draw_cursor();
+}
+
+// row >= nombre de lignes cache le curseur
+void	fb_set_cursor(size_t row, size_t col)
+{
+	if (row == cursor_row && col == cursor_col)
+		return ;
+	if (cursor_row < text_rows)
+		draw_cell(cursor_col, cursor_row, shadow[cursor_row][cursor_col]);
+	if (row >= text_rows || col >= text_cols)
+		row = TERM_MAX_ROWS;
+	cursor_row = row;
+	cursor_col = col;
+	if (cursor_row < text_rows)
+		draw_cursor();
+}
@@ -0,0 +1,113 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   font.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/09 11:48:02 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/09 16:25:39 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/fb.h"
+
+// Glyphes 5x7 dans une cellule 8x8, bit 7 = pixel de gauche. La ligne 7
+// sert aux jambages (g, j, p, q, y); hors ASCII imprimable tout est vide.
+const u8	font_8x8[FONT_GLYPHS][FONT_ROWS] = {
+	[0x20] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},	// space
+	[0x21] = {0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x10, 0x00},	// !
+	[0x22] = {0x28, 0x28, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00},	// "
+	[0x23] = {0x28, 0x28, 0x7C, 0x28, 0x7C, 0x28, 0x28, 0x00},	// #
+	[0x24] = {0x10, 0x3C, 0x50, 0x38, 0x14, 0x78, 0x10, 0x00},	// $
+	[0x25] = {0x60, 0x64, 0x08, 0x10, 0x20, 0x4C, 0x0C, 0x00},	// %
+	[0x26] = {0x30, 0x48, 0x50, 0x20, 0x54, 0x48, 0x34, 0x00},	// &
+	[0x27] = {0x10, 0x10, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00},	// quote
+	[0x28] = {0x08, 0x10, 0x20, 0x20, 0x20, 0x10, 0x08, 0x00},	// (
+	[0x29] = {0x20, 0x10, 0x08, 0x08, 0x08, 0x10, 0x20, 0x00},	// )
+	[0x2A] = {0x00, 0x10, 0x54, 0x38, 0x54, 0x10, 0x00, 0x00},	// *
+	[0x2B] = {0x00, 0x10, 0x10, 0x7C, 0x10, 0x10, 0x00, 0x00},	// +
+	[0x2C] = {0x00, 0x00, 0x00, 0x00, 0x30, 0x10, 0x20, 0x00},	// ,
+	[0x2D] = {0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x00},	// -
+	[0x2E] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00},	// .
+	[0x2F] = {0x00, 0x04, 0x08, 0x10, 0x20, 0x40, 0x00, 0x00},	// /
+	[0x30] = {0x38, 0x44, 0x4C, 0x54, 0x64, 0x44, 0x38, 0x00},	// 0
+	[0x31] = {0x10, 0x30, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00},	// 1
+	[0x32] = {0x38, 0x44, 0x04, 0x08, 0x10, 0x20, 0x7C, 0x00},	// 2
+	[0x33] = {0x7C, 0x08, 0x10, 0x08, 0x04, 0x44, 0x38, 0x00},	// 3
+	[0x34] = {0x08, 0x18, 0x28, 0x48, 0x7C, 0x08, 0x08, 0x00},	// 4
+	[0x35] = {0x7C, 0x40, 0x78, 0x04, 0x04, 0x44, 0x38, 0x00},	// 5
+	[0x36] = {0x18, 0x20, 0x40, 0x78, 0x44, 0x44, 0x38, 0x00},	// 6
+	[0x37] = {0x7C, 0x04, 0x08, 0x10, 0x20, 0x20, 0x20, 0x00},	// 7
+	[0x38] = {0x38, 0x44, 0x44, 0x38, 0x44, 0x44, 0x38, 0x00},	// 8
+	[0x39] = {0x38, 0x44, 0x44, 0x3C, 0x04, 0x08, 0x30, 0x00},	// 9
+	[0x3A] = {0x00, 0x30, 0x30, 0x00, 0x30, 0x30, 0x00, 0x00},	// :
+	[0x3B] = {0x00, 0x30, 0x30, 0x00, 0x30, 0x10, 0x20, 0x00},	// ;
+	[0x3C] = {0x08, 0x10, 0x20, 0x40, 0x20, 0x10, 0x08, 0x00},	// <
+	[0x3D] = {0x00, 0x00, 0x7C, 0x00, 0x7C, 0x00, 0x00, 0x00},	// =
+	[0x3E] = {0x20, 0x10, 0x08, 0x04, 0x08, 0x10, 0x20, 0x00},	// >
+	[0x3F] = {0x38, 0x44, 0x04, 0x08, 0x10, 0x00, 0x10, 0x00},	// ?
+	[0x40] = {0x38, 0x44, 0x04, 0x34, 0x54, 0x54, 0x38, 0x00},	// @
+	[0x41] = {0x38, 0x44, 0x44, 0x44, 0x7C, 0x44, 0x44, 0x00},	// A
+	[0x42] = {0x78, 0x44, 0x44, 0x78, 0x44, 0x44, 0x78, 0x00},	// B
+	[0x43] = {0x38, 0x44, 0x40, 0x40, 0x40, 0x44, 0x38, 0x00},	// C
+	[0x44] = {0x70, 0x48, 0x44, 0x44, 0x44, 0x48, 0x70, 0x00},	// D
+	[0x45] = {0x7C, 0x40, 0x40, 0x78, 0x40, 0x40, 0x7C, 0x00},	// E
+	[0x46] = {0x7C, 0x40, 0x40, 0x78, 0x40, 0x40, 0x40, 0x00},	// F
+	[0x47] = {0x38, 0x44, 0x40, 0x5C, 0x44, 0x44, 0x3C, 0x00},	// G
+	[0x48] = {0x44, 0x44, 0x44, 0x7C, 0x44, 0x44, 0x44, 0x00},	// H
+	[0x49] = {0x38, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00},	// I
+	[0x4A] = {0x1C, 0x08, 0x08, 0x08, 0x08, 0x48, 0x30, 0x00},	// J
+	[0x4B] = {0x44, 0x48, 0x50, 0x60, 0x50, 0x48, 0x44, 0x00},	// K
+	[0x4C] = {0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7C, 0x00},	// L
+	[0x4D] = {0x44, 0x6C, 0x54, 0x54, 0x44, 0x44, 0x44, 0x00},	// M
+	[0x4E] = {0x44, 0x44, 0x64, 0x54, 0x4C, 0x44, 0x44, 0x00},	// N
+	[0x4F] = {0x38, 0x44, 0x44, 0x44, 0x44, 0x44, 0x38, 0x00},	// O
+	[0x50] = {0x78, 0x44, 0x44, 0x78, 0x40, 0x40, 0x40, 0x00},	// P
+	[0x51] = {0x38, 0x44, 0x44, 0x44, 0x54, 0x48, 0x34, 0x00},	// Q
+	[0x52] = {0x78, 0x44, 0x44, 0x78, 0x50, 0x48, 0x44, 0x00},	// R
+	[0x53] = {0x3C, 0x40, 0x40, 0x38, 0x04, 0x04, 0x78, 0x00},	// S
+	[0x54] = {0x7C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00},	// T
+	[0x55] = {0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x38, 0x00},	// U
+	[0x56] = {0x44, 0x44, 0x44, 0x44, 0x44, 0x28, 0x10, 0x00},	// V
+	[0x57] = {0x44, 0x44, 0x44, 0x54, 0x54, 0x54, 0x28, 0x00},	// W
+	[0x58] = {0x44, 0x44, 0x28, 0x10, 0x28, 0x44, 0x44, 0x00},	// X
+	[0x59] = {0x44, 0x44, 0x44, 0x28, 0x10, 0x10, 0x10, 0x00},	// Y
+	[0x5A] = {0x7C, 0x04, 0x08, 0x10, 0x20, 0x40, 0x7C, 0x00},	// Z
+	[0x5B] = {0x38, 0x20, 0x20, 0x20, 0x20, 0x20, 0x38, 0x00},	// [
+	[0x5C] = {0x00, 0x40, 0x20, 0x10, 0x08, 0x04, 0x00, 0x00},	// backslash
+	[0x5D] = {0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x38, 0x00},	// ]
+	[0x5E] = {0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00},	// ^
+	[0x5F] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x00},	// _
+	[0x60] = {0x20, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00},	// `
+	[0x61] = {0x00, 0x00, 0x38, 0x04, 0x3C, 0x44, 0x3C, 0x00},	// a
+	[0x62] = {0x40, 0x40, 0x58, 0x64, 0x44, 0x44, 0x78, 0x00},	// b
+	[0x63] = {0x00, 0x00, 0x38, 0x40, 0x40, 0x44, 0x38, 0x00},	// c
+	[0x64] = {0x04, 0x04, 0x34, 0x4C, 0x44, 0x44, 0x3C, 0x00},	// d
+	[0x65] = {0x00, 0x00, 0x38, 0x44, 0x7C, 0x40, 0x38, 0x00},	// e
+	[0x66] = {0x18, 0x24, 0x20, 0x70, 0x20, 0x20, 0x20, 0x00},	// f
+	[0x67] = {0x00, 0x00, 0x3C, 0x44, 0x44, 0x3C, 0x04, 0x38},	// g
+	[0x68] = {0x40, 0x40, 0x58, 0x64, 0x44, 0x44, 0x44, 0x00},	// h
+	[0x69] = {0x10, 0x00, 0x30, 0x10, 0x10, 0x10, 0x38, 0x00},	// i
+	[0x6A] = {0x08, 0x00, 0x18, 0x08, 0x08, 0x08, 0x48, 0x30},	// j
+	[0x6B] = {0x40, 0x40, 0x48, 0x50, 0x60, 0x50, 0x48, 0x00},	// k
+	[0x6C] = {0x30, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00},	// l
+	[0x6D] = {0x00, 0x00, 0x68, 0x54, 0x54, 0x44, 0x44, 0x00},	// m
+	[0x6E] = {0x00, 0x00, 0x58, 0x64, 0x44, 0x44, 0x44, 0x00},	// n
+	[0x6F] = {0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00},	// o
+	[0x70] = {0x00, 0x00, 0x78, 0x44, 0x44, 0x78, 0x40, 0x40},	// p
+	[0x71] = {0x00, 0x00, 0x3C, 0x44, 0x44, 0x3C, 0x04, 0x04},	// q
+	[0x72] = {0x00, 0x00, 0x58, 0x64, 0x40, 0x40, 0x40, 0x00},	// r
+	[0x73] = {0x00, 0x00, 0x38, 0x40, 0x38, 0x04, 0x78, 0x00},	// s
+	[0x74] = {0x20, 0x20, 0x70, 0x20, 0x20, 0x24, 0x18, 0x00},	// t
+	[0x75] = {0x00, 0x00, 0x44, 0x44, 0x44, 0x4C, 0x34, 0x00},	// u
+	[0x76] = {0x00, 0x00, 0x44, 0x44, 0x44, 0x28, 0x10, 0x00},	// v
+	[0x77] = {0x00, 0x00, 0x44, 0x44, 0x54, 0x54, 0x28, 0x00},	// w
+	[0x78] = {0x00, 0x00, 0x44, 0x28, 0x10, 0x28, 0x44, 0x00},	// x
+	[0x79] = {0x00, 0x00, 0x44, 0x44, 0x44, 0x3C, 0x04, 0x38},	// y
+	[0x7A] = {0x00, 0x00, 0x7C, 0x08, 0x10, 0x20, 0x7C, 0x00},	// z
+	[0x7B] = {0x08, 0x10, 0x10, 0x20, 0x10, 0x10, 0x08, 0x00},	// {
+	[0x7C] = {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00},	// |
+	[0x7D] = {0x20, 0x10, 0x10, 0x08, 0x10, 0x10, 0x20, 0x00},	// }
+	[0x7E] = {0x00, 0x00, 0x20, 0x54, 0x08, 0x00, 0x00, 0x00},	// ~
+};
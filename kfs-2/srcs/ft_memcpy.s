@@ -1,9 +1,17 @@
 ; ft_memcpy.s
 ; void	*ft_memcpy(void *dest, const void *src, size_t n)
+; void	*ft_memcpy_bytewise(void *dest, const void *src, size_t n)
 
 section .text
 	global ft_memcpy
+	global memcpy
+	global ft_memcpy_bytewise
 
+; Copie par dwords: tete octet par octet jusqu'a aligner dest sur 4,
+; corps en rep movsd, puis les 0-3 octets restants.
+; memcpy, memset et memmove pointent sur nos versions: gcc en emet des
+; appels meme avec -ffreestanding (copies de grosses structures)
+memcpy:
 ft_memcpy:
 	push	ebp
 	mov		ebp, esp
@@ -13,14 +21,51 @@ ft_memcpy:
 	mov		edi, [ebp + 8]
 	mov		esi, [ebp + 12]
 	mov		ecx, [ebp + 16]
-	
+
+	mov		eax, edi
+	cld
+	cmp		ecx, 16
+	jb		.tail
+
+	mov		edx, edi
+	neg		edx
+	and		edx, 3
+	sub		ecx, edx
+	xchg	ecx, edx
+	rep		movsb
+
+	mov		ecx, edx
+	shr		ecx, 2
+	rep		movsd
+	mov		ecx, edx
+	and		ecx, 3
+
+.tail:
+	rep		movsb
+
+	pop		edi
+	pop		esi
+	pop		ebp
+	ret
+
+; Ancienne copie octet par octet, gardee comme reference pour les mesures.
+ft_memcpy_bytewise:
+	push	ebp
+	mov		ebp, esp
+	push	esi
+	push	edi
+
+	mov		edi, [ebp + 8]
+	mov		esi, [ebp + 12]
+	mov		ecx, [ebp + 16]
+
 	mov		eax, edi
 	cmp		ecx, 0
 	je		.end
 
 .loop:
-	mov		bl, [esi]
-	mov		[edi], bl
+	mov		dl, [esi]
+	mov		[edi], dl
 	inc		esi
 	inc		edi
 	dec		ecx
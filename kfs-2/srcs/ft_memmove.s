@@ -0,0 +1,83 @@
+; ft_memmove.s
+; void	*ft_memmove(void *dest, const void *src, size_t n)
+
+section .text
+	global	ft_memmove
+	global	memmove
+
+memmove:
+ft_memmove:
+	push	ebp
+	mov		ebp, esp
+	push	esi
+	push	edi
+
+	mov		edi, [ebp + 8]
+	mov		esi, [ebp + 12]
+	mov		ecx, [ebp + 16]
+
+	mov		eax, edi
+	cld
+
+	; (dest - src) >= n (non signe): pas de recouvrement genant,
+	; la copie vers l'avant est sure
+	mov		edx, edi
+	sub		edx, esi
+	cmp		edx, ecx
+	jb		.backward
+
+	cmp		ecx, 16
+	jb		.tail
+
+	mov		edx, edi
+	neg		edx
+	and		edx, 3
+	sub		ecx, edx
+	xchg	ecx, edx
+	rep		movsb
+
+	mov		ecx, edx
+	shr		ecx, 2
+	rep		movsd
+	mov		ecx, edx
+	and		ecx, 3
+
+.tail:
+	rep		movsb
+	jmp		.end
+
+; dest chevauche la fin de src: on copie depuis la fin
+.backward:
+	std
+	lea		esi, [esi + ecx - 1]
+	lea		edi, [edi + ecx - 1]
+	cmp		ecx, 16
+	jb		.back_tail
+
+	; aligne la fin de dest sur 4
+	mov		edx, edi
+	inc		edx
+	and		edx, 3
+	sub		ecx, edx
+	xchg	ecx, edx
+	rep		movsb
+
+	sub		esi, 3
+	sub		edi, 3
+	mov		ecx, edx
+	shr		ecx, 2
+	rep		movsd
+	add		esi, 3
+	add		edi, 3
+	mov		ecx, edx
+	and		ecx, 3
+
+.back_tail:
+	rep		movsb
+	cld
+
+.end:
+	pop		edi
+	pop		esi
+	pop		ebp
+	ret
@@ -3,26 +3,43 @@
 
 section .text
 	global	ft_memset
+	global	memset
 
+memset:
 ft_memset:
 	push	ebp
 	mov		ebp, esp
 	push	edi
 	mov		edi, [ebp + 8]
-	mov		eax, [ebp + 12]
+	movzx	eax, byte [ebp + 12]
 	mov		ecx, [ebp + 16]
 
 	mov		edx, edi
-	cmp		ecx, 0
-	je		.end
+	cld
+	cmp		ecx, 16
+	jb		.tail
 
-.loop:
-	mov		[edi], al
-	inc		edi
-	dec		ecx
-	jnz		.loop
+	; repete l'octet dans les 4 octets de eax
+	imul	eax, eax, 0x01010101
+
+	push	edx
+	mov		edx, edi
+	neg		edx
+	and		edx, 3
+	sub		ecx, edx
+	xchg	ecx, edx
+	rep		stosb
+
+	mov		ecx, edx
+	shr		ecx, 2
+	rep		stosd
+	mov		ecx, edx
+	and		ecx, 3
+	pop		edx
+
+.tail:
+	rep		stosb
 
-.end:
 	mov		eax, edx
 	pop		edi
 	pop		ebp
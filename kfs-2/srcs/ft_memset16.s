@@ -0,0 +1,43 @@
+; ft_memset16.s
+; u16	*ft_memset16(u16 *s, u16 value, size_t count)
+
+section .text
+	global	ft_memset16
+
+; Remplit count mots de 16 bits, deux par deux avec rep stosd
+; (une ligne VGA de 80 cellules = 40 stores).
+ft_memset16:
+	push	ebp
+	mov		ebp, esp
+	push	edi
+	mov		edi, [ebp + 8]
+	movzx	eax, word [ebp + 12]
+	mov		ecx, [ebp + 16]
+
+	cld
+	test	ecx, ecx
+	jz		.end
+
+	mov		edx, eax
+	shl		edx, 16
+	or		eax, edx
+
+	; dest sur 2 mod 4: une cellule seule pour s'aligner
+	test	edi, 2
+	jz		.aligned
+	stosw
+	dec		ecx
+
+.aligned:
+	mov		edx, ecx
+	shr		ecx, 1
+	rep		stosd
+	test	edx, 1
+	jz		.end
+	stosw
+
+.end:
+	mov		eax, [ebp + 8]
+	pop		edi
+	pop		ebp
+	ret
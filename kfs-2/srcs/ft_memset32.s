@@ -0,0 +1,22 @@
+; ft_memset32.s
+; u32	*ft_memset32(u32 *s, u32 value, size_t count)
+
+section .text
+	global	ft_memset32
+
+ft_memset32:
+	push	ebp
+	mov		ebp, esp
+	push	edi
+	mov		edi, [ebp + 8]
+	mov		eax, [ebp + 12]
+	mov		ecx, [ebp + 16]
+
+	mov		edx, edi
+	cld
+	rep		stosd
+
+	mov		eax, edx
+	pop		edi
+	pop		ebp
+	ret
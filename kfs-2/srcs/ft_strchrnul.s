@@ -0,0 +1,100 @@
+; ft_strchrnul
+; char	*ft_strchrnul(const char *s, int c)
+
+extern	cpu_has_sse2
+
+section .text
+	global	ft_strchrnul
+
+; Meme moteur que ft_strlen: s'arrete sur c ou sur le '\0' final.
+ft_strchrnul:
+	push	ebp
+	mov		ebp, esp
+	push	ebx
+	push	esi
+	push	edi
+	mov		eax, [ebp + 8]
+	movzx	edx, byte [ebp + 12]
+	cmp		dword [cpu_has_sse2], 0
+	jne		.sse2
+
+.head:
+	test	eax, 3
+	jz		.words_init
+	mov		cl, [eax]
+	test	cl, cl
+	jz		.end
+	cmp		cl, dl
+	je		.end
+	inc		eax
+	jmp		.head
+
+.words_init:
+	imul	esi, edx, 0x01010101
+
+.words:
+	mov		ecx, [eax]
+	lea		ebx, [ecx - 0x01010101]
+	mov		edi, ecx
+	not		edi
+	and		ebx, edi
+	xor		ecx, esi
+	lea		edi, [ecx - 0x01010101]
+	not		ecx
+	and		edi, ecx
+	or		ebx, edi
+	test	ebx, 0x80808080
+	jnz		.bytes
+	add		eax, 4
+	jmp		.words
+
+.bytes:
+	mov		cl, [eax]
+	test	cl, cl
+	jz		.end
+	cmp		cl, dl
+	je		.end
+	inc		eax
+	jmp		.bytes
+
+.sse2:
+	imul	edx, edx, 0x01010101
+	movd	xmm2, edx
+	pshufd	xmm2, xmm2, 0
+	pxor	xmm0, xmm0
+	mov		ecx, eax
+	and		ecx, 15
+	and		eax, -16
+	movdqa	xmm1, [eax]
+	movdqa	xmm3, xmm1
+	pcmpeqb	xmm1, xmm0
+	pcmpeqb	xmm3, xmm2
+	por		xmm1, xmm3
+	pmovmskb	ebx, xmm1
+	shr		ebx, cl
+	test	ebx, ebx
+	jz		.sse2_loop
+	bsf		ebx, ebx
+	add		eax, ecx
+	add		eax, ebx
+	jmp		.end
+
+.sse2_loop:
+	add		eax, 16
+	movdqa	xmm1, [eax]
+	movdqa	xmm3, xmm1
+	pcmpeqb	xmm1, xmm0
+	pcmpeqb	xmm3, xmm2
+	por		xmm1, xmm3
+	pmovmskb	ebx, xmm1
+	test	ebx, ebx
+	jz		.sse2_loop
+	bsf		ebx, ebx
+	add		eax, ebx
+
+.end:
+	pop		edi
+	pop		esi
+	pop		ebx
+	pop		ebp
+	ret
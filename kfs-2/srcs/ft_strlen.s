@@ -1,21 +1,75 @@
 ; ft_strlen
 ; size_t	ft_strlen(const char *s)
 
+extern	cpu_has_sse2
+
 section .text
 	global	ft_strlen
 
 ft_strlen:
 	push	ebp
 	mov		ebp, esp
-	mov		eax, 0
-	mov		edi, [ebp + 8]
+	push	ebx
+	mov		eax, [ebp + 8]
+	mov		edx, eax
+	cmp		dword [cpu_has_sse2], 0
+	jne		.sse2
+
+; octet par octet jusqu'a un dword aligne
+.head:
+	test	eax, 3
+	jz		.words
+	cmp		byte [eax], 0
+	je		.end
+	inc		eax
+	jmp		.head
+
+; (x - 0x01010101) & ~x & 0x80808080 != 0 <=> x contient un octet nul
+.words:
+	mov		ecx, [eax]
+	lea		ebx, [ecx - 0x01010101]
+	not		ecx
+	and		ebx, ecx
+	test	ebx, 0x80808080
+	jnz		.bytes
+	add		eax, 4
+	jmp		.words
 
-.loop:
-	cmp		byte [edi + eax], 0
+.bytes:
+	cmp		byte [eax], 0
 	je		.end
 	inc		eax
-	jmp		.loop
+	jmp		.bytes
+
+; 16 octets par tour; les lectures alignees ne sortent jamais de la page
+.sse2:
+	mov		ecx, eax
+	and		ecx, 15
+	and		eax, -16
+	pxor	xmm0, xmm0
+	movdqa	xmm1, [eax]
+	pcmpeqb	xmm1, xmm0
+	pmovmskb	ebx, xmm1
+	shr		ebx, cl
+	test	ebx, ebx
+	jz		.sse2_loop
+	bsf		eax, ebx
+	pop		ebx
+	pop		ebp
+	ret
+
+.sse2_loop:
+	add		eax, 16
+	movdqa	xmm1, [eax]
+	pcmpeqb	xmm1, xmm0
+	pmovmskb	ebx, xmm1
+	test	ebx, ebx
+	jz		.sse2_loop
+	bsf		ebx, ebx
+	add		eax, ebx
 
 .end:
+	sub		eax, edx
+	pop		ebx
 	pop		ebp
 	ret
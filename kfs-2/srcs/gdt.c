@@ -13,7 +13,11 @@
 #include "../includes/gdt.h"
 #include "../includes/kernel.h"
 
-t_gdt_entry	*gdt = (t_gdt_entry *)GDT_BASE_ADRESS;
+// _gdt_start vaut GDT_BASE_ADRESS (linker.ld). Passer par le symbole evite
+// que gcc -O2/LTO prenne 0x800 pour un pointeur nul decale.
+extern t_gdt_entry	_gdt_start[];
+
+t_gdt_entry	*gdt = _gdt_start;
 t_gdt_ptr	gdt_ptr;
 
 extern void	gdt_flush(u32 gdt_ptr_addr);
@@ -58,9 +62,35 @@ void	gdt_init(void)
 
 	gdt_set_gate(GDT_USER_STACK_SEGMENT, 0, 0xFFFFFFFF, GDT_USER_DATA_ACCESS | GDT_GROW_DOWN, GDT_FLAGS_32BIT);
 
+	// 0x800 n'est pas charge par GRUB: les entrees par CPU partent a zero
+	for (u32 num = GDT_CPU_SEGMENTS; num < GDT_ENTRIES_COUNT; ++num)
+		gdt_set_gate(num, 0, 0, 0, 0);
+
 	gdt_flush((u32)&gdt_ptr);
 }
 
+// Entrees propres a un CPU: sa TSS, et un segment de donnees qui couvre
+// exactement sa zone par CPU
+void	gdt_set_cpu(u32 cpu, t_tss *tss, u32 esp0, void *data, u32 size)
+{
+	ft_memset(tss, 0, sizeof(t_tss));
+	tss->ss0 = GDT_KERNEL_DATA_SEGMENT << 3;
+	tss->esp0 = esp0;
+	tss->iomap_base = sizeof(t_tss);
+	gdt_set_gate(GDT_CPU_TSS(cpu), (u32)tss, sizeof(t_tss) - 1, GDT_TSS_ACCESS, 0);
+	gdt_set_gate(GDT_CPU_DATA(cpu), (u32)data, size - 1, GDT_KERNEL_DATA_ACCESS, GDT_32BIT);
+}
+
+// Sur le CPU concerne: TR et gs sont des registres propres a chaque coeur
+void	gdt_load_cpu(u32 cpu)
+{
+	u16	tss = GDT_CPU_TSS(cpu) << 3;
+	u16	data = GDT_CPU_DATA(cpu) << 3;
+
+	__asm__ volatile ("ltr %0" : : "r"(tss));
+	__asm__ volatile ("mov %0, %%gs" : : "r"(data) : "memory");
+}
+
 void	print_gdt(void)
 {
 	terminal_set_color(VGA_COLOR_LIGHT_CYAN);
@@ -87,8 +117,8 @@ void	print_stack(void)
 
 	printk("Stack contents (16 most recent values):\n");
 	printk("Address      | Offset | Value\n");
-	printk("-------------|--------|----------\n");
+	printk("-------------|--------|-----------\n");
 
 	for (int i = 0; i < 16 && (esp + i) <= ebp; i++)
-		printk("0x%x | +%d | 0x%x\n", (u32)(esp + i), i * 4, *(esp + i));
+		printk("0x%08x   | +%-5d | 0x%08x\n", (u32)(esp + i), i * 4, *(esp + i));
 } 
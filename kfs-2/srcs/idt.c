@@ -0,0 +1,110 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   idt.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/24 14:05:29 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/24 18:37:45 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/idt.h"
+#include "../includes/pic.h"
+#include "../includes/kernel.h"
+#include "../includes/log.h"
+
+t_idt_entry				idt[IDT_ENTRIES_COUNT];
+t_idt_ptr				idt_ptr;
+
+static t_isr_handler	isr_handlers[IDT_ENTRIES_COUNT];
+
+extern void	idt_flush(u32 idt_ptr_addr);
+extern u32	isr_stub_table[IRQ_BASE + IRQ_COUNT];
+
+static const char	*exception_names[IRQ_BASE] = {
+	"Divide error", "Debug", "NMI", "Breakpoint",
+	"Overflow", "Bound range exceeded", "Invalid opcode", "Device not available",
+	"Double fault", "Coprocessor segment overrun", "Invalid TSS", "Segment not present",
+	"Stack-segment fault", "General protection fault", "Page fault", "Reserved",
+	"x87 floating-point", "Alignment check", "Machine check", "SIMD floating-point",
+	"Virtualization", "Control protection", "Reserved", "Reserved",
+	"Reserved", "Reserved", "Reserved", "Reserved",
+	"Reserved", "Reserved", "Security", "Reserved"
+};
+
+void	idt_set_gate(u8 num, u32 handler, u16 selector, u8 type_attr)
+{
+	idt[num].offset_low = handler & 0xFFFF;
+	idt[num].offset_high = (handler >> 16) & 0xFFFF;
+	idt[num].selector = selector;
+	idt[num].zero = 0;
+	idt[num].type_attr = type_attr;
+}
+
+void	idt_init(void)
+{
+	idt_ptr.limit = (sizeof(t_idt_entry) * IDT_ENTRIES_COUNT) - 1;
+	idt_ptr.base = (u32)&idt;
+
+	ft_memset(idt, 0, sizeof(idt));
+	for (u8 num = 0; num < IRQ_BASE + IRQ_COUNT; ++num)
+		idt_set_gate(num, isr_stub_table[num], IDT_KERNEL_CODE_SELECTOR, IDT_INTERRUPT_GATE);
+
+	pic_remap(IRQ_BASE, IRQ_BASE + 8);
+	idt_flush((u32)&idt_ptr);
+}
+
+// Pour les APs: la table est partagee, seul IDTR est propre a chaque CPU
+void	idt_load(void)
+{
+	idt_flush((u32)&idt_ptr);
+}
+
+void	isr_register_handler(u8 num, t_isr_handler handler)
+{
+	isr_handlers[num] = handler;
+}
+
+void	irq_register_handler(u8 irq, t_isr_handler handler)
+{
+	isr_handlers[IRQ_BASE + irq] = handler;
+	pic_unmask_irq(irq);
+}
+
+static void	unhandled_exception(t_registers *regs)
+{
+	printk(KERN_ERR "\n[EXCEPTION] %s (%d), error 0x%x at 0x%x\n",
+		exception_names[regs->int_no], regs->int_no, regs->err_code, regs->eip);
+	log_panic();
+	asm volatile ("cli; hlt");
+}
+
+// Point d'entree commun de toutes les interruptions (appele par isr_common)
+void	isr_handler(t_registers *regs)
+{
+	u32	num = regs->int_no;
+
+	if (num < IRQ_BASE)
+	{
+		if (isr_handlers[num])
+			isr_handlers[num](regs);
+		else
+			unhandled_exception(regs);
+		return ;
+	}
+
+	u8	irq = num - IRQ_BASE;
+
+	// IRQ 7/15 fantomes: le PIC ne les a pas vraiment servies, pas d'EOI
+	if ((irq == 7 || irq == 15) && !(pic_get_isr() & (1 << irq)))
+	{
+		if (irq == 15)
+			pic_send_eoi(IRQ_CASCADE);
+		return ;
+	}
+	if (isr_handlers[num])
+		isr_handlers[num](regs);
+	pic_send_eoi(irq);
+}
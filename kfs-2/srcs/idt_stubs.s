@@ -0,0 +1,118 @@
+; **************************************************************************** ;
+;                                                                              ;
+;                                                         :::      ::::::::    ;
+;    idt_stubs.s                                        :+:      :+:    :+:    ;
+;                                                     +:+ +:+         +:+      ;
+;    By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+         ;
+;                                                 +#+#+#+#+#+   +#+            ;
+;    Created: 2026/01/24 14:31:08 by lumugot           #+#    #+#              ;
+;    Updated: 2026/01/24 17:52:26 by lumugot          ###   ########.fr        ;
+;                                                                              ;
+; **************************************************************************** ;
+
+BITS	32
+
+extern	isr_handler
+
+global	idt_flush
+global	isr_stub_table
+global	isr_spurious
+
+idt_flush:
+	mov		eax, [esp + 4]
+	lidt	[eax]
+	ret
+
+; Exceptions sans code d'erreur: on pousse 0 pour garder le meme t_registers
+%macro ISR_NOERR 1
+isr%1:
+	push	dword 0
+	push	dword %1
+	jmp		isr_common
+%endmacro
+
+%macro ISR_ERR 1
+isr%1:
+	push	dword %1
+	jmp		isr_common
+%endmacro
+
+ISR_NOERR	0
+ISR_NOERR	1
+ISR_NOERR	2
+ISR_NOERR	3
+ISR_NOERR	4
+ISR_NOERR	5
+ISR_NOERR	6
+ISR_NOERR	7
+ISR_ERR		8
+ISR_NOERR	9
+ISR_ERR		10
+ISR_ERR		11
+ISR_ERR		12
+ISR_ERR		13
+ISR_ERR		14
+ISR_NOERR	15
+ISR_NOERR	16
+ISR_ERR		17
+ISR_NOERR	18
+ISR_NOERR	19
+ISR_NOERR	20
+ISR_ERR		21
+ISR_NOERR	22
+ISR_NOERR	23
+ISR_NOERR	24
+ISR_NOERR	25
+ISR_NOERR	26
+ISR_NOERR	27
+ISR_NOERR	28
+ISR_ERR		29
+ISR_ERR		30
+ISR_NOERR	31
+
+; IRQ 0-15 du PIC, remappees sur les vecteurs 32-47
+%assign i 32
+%rep 16
+isr%+i:
+	push	dword 0
+	push	dword i
+	jmp		isr_common
+%assign i i + 1
+%endrep
+
+isr_common:
+	pusha
+	push	ds
+	push	es
+	push	fs
+	push	gs
+
+	mov		ax, 0x10
+	mov		ds, ax
+	mov		es, ax
+
+	cld
+	push	esp
+	call	isr_handler
+	add		esp, 4
+
+	pop		gs
+	pop		fs
+	pop		es
+	pop		ds
+	popa
+	add		esp, 8
+	iret
+
+; Interruption parasite du LAPIC: pas de handler, et surtout pas d'EOI
+isr_spurious:
+	iret
+
+section .data
+align 4
+isr_stub_table:
+%assign i 0
+%rep 48
+	dd		isr%+i
+%assign i i + 1
+%endrep
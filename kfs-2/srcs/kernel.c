@@ -2,22 +2,51 @@
 #include "../includes/stdbool.h"
 #include "../includes/io.h"
 #include "../includes/gdt.h"
+#include "../includes/idt.h"
+#include "../includes/keyboard.h"
+#include "../includes/timer.h"
+#include "../includes/console.h"
+#include "../includes/serial.h"
+#include "../includes/pmm.h"
+#include "../includes/paging.h"
+#include "../includes/kmalloc.h"
+#include "../includes/shell.h"
+#include "../includes/bench.h"
+#include "../includes/trace.h"
+#include "../includes/boottime.h"
+#include "../includes/fb.h"
+#include "../includes/smp.h"
+#include "../includes/lock.h"
+#include "../includes/log.h"
 
-size_t			terminal_row = 0;
-size_t			terminal_column = 0;
-u8				terminal_color = 0;
-volatile u16	*terminal_buffer = 0;
 size_t			current_screen = 0;
+size_t			term_cols = VGA_WIDTH;
+size_t			term_rows = VGA_HEIGHT;
 t_screen		screens[NUM_SCREENS];
-size_t			input_end = PROMPT_LENGTH;
+t_screen		*term = &screens[0];
 
 static bool		shift_pressed =	false;
 static bool		caps_lock =	false;
 static bool		ctrl_pressed = false;
 static bool		alt_pressed = false;
+static bool		extended = false;
+
+static	u16		cursor_pos = 0xFFFF;
+
+// Ecran courant, couleur, position, saisie, historique, dirty spans et ports CRTC.
+// Les fonctions publiques qui les modifient prennent ce verrou; les helpers
+// bas niveau (terminal_putentry, terminal_putchar, terminal_scroll,
+// terminal_mark_dirty*) supposent qu'il est deja tenu.
+static	t_spinlock	terminal_lock = SPINLOCK_INIT("terminal");
+
+static	t_console	vga_console = {"vga", terminal_write, false};
+
+// Tout le rendu se fait dans l'historique circulaire de l'ecran courant,
+// terminal_flush() ne recopie vers sa page VGA (ou le framebuffer) que les
+// colonnes [dirty_start, dirty_end) des lignes visibles modifiees
+static	u8				dirty_start[TERM_MAX_ROWS];
+static	u8				dirty_end[TERM_MAX_ROWS];
 
-static	char	input_buffer[INPUT_MAX];
-static	size_t	input_len = 0;
 
 static const char scancode_to_ascii[128] = {
     0,27,'1','2','3','4','5','6','7','8',
@@ -50,208 +79,473 @@ static inline u16	vga_entry(unsigned char uc, u8 color)
 	return ((u16)uc | (u16)color << 8);
 }
 
+// Ligne y de la fenetre vivante (celle ou l'on ecrit)
+static inline u16	*terminal_line(size_t y)
+{
+	return (term->lines[(term->top + y) & SCROLLBACK_MASK]);
+}
+
+// Chaque ecran a sa propre page de la memoire texte VGA (8 x 4 Ko a 0xB8000)
+static void	set_display_start(u16 offset)
+{
+	outb(0x3D4, 0x0C);
+	outb(0x3D5, (offset >> 8) & 0xFF);
+	outb(0x3D4, 0x0D);
+	outb(0x3D5, offset & 0xFF);
+}
+
 void	terminal_initialize()
 {
-	terminal_row = 0;
-	terminal_column = 0;
-	terminal_color = vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK);
-	terminal_buffer = (u16*)VGA_MEMORY;
-	current_screen = 0;
-	input_end = PROMPT_LENGTH;
-	
-	size_t	y = 0;
-	while (y < VGA_HEIGHT)
-	{
-		size_t x = 0;
-		while (x < VGA_WIDTH)
-		{
-			const size_t index = (y * VGA_WIDTH) + x;
-			terminal_buffer[index] = vga_entry(' ', terminal_color);
-			x++;
-		}
-		y++;
-	}
-	print_prompt();
-	for (size_t s = 0; s < NUM_SCREENS; ++s)
+	for (size_t s = NUM_SCREENS; s-- > 0; )
 	{
-		screens[s].save_row = 0;
-		screens[s].save_column = 0;
-		screens[s].save_input_end = PROMPT_LENGTH;
-		screens[s].save_color = vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK);	
-		ft_memcpy(screens[s].save_buffer, (void *)terminal_buffer, VGA_WIDTH * VGA_HEIGHT * sizeof(u16));
+		term = &screens[s];
+		current_screen = s;
+		term->page_start = s * VGA_PAGE_CELLS;
+		term->page = (u16 *)VGA_MEMORY + term->page_start;
+		term->top = 0;
+		term->history = 0;
+		term->view_offset = 0;
+		term->row = 0;
+		term->column = 0;
+		term->color = vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK);
+		term->input_end = PROMPT_LENGTH;
+		term->input_len = 0;
+
+		term->painted = false;
+
+		ft_memset16(term->lines[0], vga_entry(' ', term->color), TERM_MAX_COLS * TERM_MAX_ROWS);
+		// Celui de l'ecran 0 vient de kernel_main, apres les messages du boot
+		if (s != 0)
+			print_prompt();
 	}
+	// Seul l'ecran 0 est affiche: les autres pages VGA attendent leur premier switch
+	term->painted = true;
+	terminal_mark_dirty_all();
+	terminal_flush();
+	set_display_start(term->page_start);
+	console_register(&vga_console);
+}
+
+// Bascule sur le framebuffer: la grille s'agrandit, les historiques sont gardes
+void	terminal_set_framebuffer(size_t cols, size_t rows)
+{
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	term_cols = cols;
+	term_rows = rows;
+	terminal_mark_dirty_all();
+	spin_unlock_irqrestore(&terminal_lock, flags);
+	terminal_flush();
 }
 
 void	terminal_clear_screen()
 {
-    for (size_t y = 0; y < VGA_HEIGHT; y++)
-        for (size_t x = 0; x < VGA_WIDTH; x++)
-            terminal_buffer[y * VGA_WIDTH + x] = vga_entry(' ', terminal_color);
+	u32	flags;
+
+	log_drain();
+	flags = spin_lock_irqsave(&terminal_lock);
+	for (size_t y = 0; y < term_rows; ++y)
+		ft_memset16(terminal_line(y), vga_entry(' ', term->color), TERM_MAX_COLS);
+	terminal_mark_dirty_all();
+
+    term->row = 0;
+    term->column = 0;
+	term->color = vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK);
+	spin_unlock_irqrestore(&terminal_lock, flags);
+}
 
-    terminal_row = 0;
-    terminal_column = 0;
-	terminal_color = vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK);
+// Message fatal: la faute a pu tomber avec terminal_lock pris
+void	terminal_panic(void)
+{
+	spin_force_unlock(&terminal_lock);
 }
 
+// Les messages en attente gardent la couleur avec laquelle ils ont ete ecrits
 void	terminal_set_color(u8 color)
 {
-	terminal_color = color;
+	u32	flags;
+
+	log_drain();
+	flags = spin_lock_irqsave(&terminal_lock);
+	term->color = color;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
+// Ne touche aux ports CRTC que pour les octets de position qui ont change
 void	set_cursor(u16 row, u16 col)
 {
-	u16	pos = row * 80 + col;
+	u16	pos;
+
+	if (fb_enabled())
+	{
+		fb_set_cursor(row, col);
+		return ;
+	}
+	pos = term->page_start + row * VGA_WIDTH + col;
+	if (pos == cursor_pos)
+		return ;
+
+	TRACE(TRACE_CURSOR, pos, cursor_pos);
+	if ((pos & 0xFF) != (cursor_pos & 0xFF))
+	{
+		outb(0x3D4, 0x0F);
+		outb(0x3D5, pos & 0xFF);
+	}
+	if ((pos >> 8) != (cursor_pos >> 8))
+	{
+		outb(0x3D4, 0x0E);
+		outb(0x3D5, (pos >> 8) & 0xFF);
+	}
+	cursor_pos = pos;
+}
+
+// Le curseur materiel n'est synchronise qu'au flush, avant d'attendre une touche.
+// En remontant l'historique on le place hors ecran pour le cacher.
+void	terminal_sync_cursor(void)
+{
+	if (term->view_offset)
+		set_cursor(term_rows, 0);
+	else
+		set_cursor(term->row, term->column);
+}
+
+void	terminal_mark_dirty(size_t x, size_t y, size_t len)
+{
+	if (dirty_end[y] == 0)
+	{
+		dirty_start[y] = x;
+		dirty_end[y] = x + len;
+		return ;
+	}
+	if (x < dirty_start[y])
+		dirty_start[y] = x;
+	if (x + len > dirty_end[y])
+		dirty_end[y] = x + len;
+}
+
+void	terminal_mark_dirty_all(void)
+{
+	ft_memset(dirty_start, 0, sizeof(dirty_start));
+	ft_memset(dirty_end, term_cols, sizeof(dirty_end));
+}
+
+// La ligne vivante y s'affiche view_offset lignes plus bas quand on remonte
+// l'historique, et plus du tout si elle sort par le bas de l'ecran
+static void	terminal_mark_live(size_t x, size_t y, size_t len)
+{
+	if (y + term->view_offset < term_rows)
+		terminal_mark_dirty(x, y + term->view_offset, len);
+}
+
+// La fenetre affichee commence view_offset lignes au-dessus de la fenetre vivante
+void	terminal_flush(void)
+{
+	u32		flags;
+	size_t	first;
+	bool	index_dirty;
+
+	// Le drain ecrit dans le terminal: avant de prendre terminal_lock
+	log_drain();
+	flags = spin_lock_irqsave(&terminal_lock);
+	first = term->top - term->view_offset;
+	index_dirty = dirty_end[0] != 0;
 
-	outb(0x3D4, 0x0F);
-	outb(0x3D5, pos & 0xFF);
+	TRACE(TRACE_FLUSH_BEGIN, term->top, term->view_offset);
 
-	outb(0x3D4, 0x0E);
-    outb(0x3D5, (pos >> 8) & 0xFF);
+	for (size_t y = 0; y < term_rows; ++y)
+	{
+		if (dirty_end[y] == 0)
+			continue ;
+
+		u16	*line = term->lines[(first + y) & SCROLLBACK_MASK];
+		if (fb_enabled())
+			fb_draw_cells(dirty_start[y], y, line + dirty_start[y], dirty_end[y] - dirty_start[y]);
+		else
+			ft_memcpy((void *)(term->page + y * VGA_WIDTH + dirty_start[y]), line + dirty_start[y],
+				(dirty_end[y] - dirty_start[y]) * sizeof(u16));
+		dirty_end[y] = 0;
+	}
+	if (index_dirty)
+		draw_screen_index();
+	terminal_sync_cursor();
+	TRACE(TRACE_FLUSH_END, 0, 0);
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
 void	terminal_putentry(char c, u8 color, size_t x, size_t y)
 {
-	const size_t index = y * VGA_WIDTH + x;
-	terminal_buffer[index] = vga_entry(c, color);
+	terminal_line(y)[x] = vga_entry(c, color);
+	terminal_mark_live(x, y, 1);
 }
 
+// Scroller n'avance que l'index de tete de l'historique: O(1) par ligne,
+// et plusieurs scrolls entre deux flush ne coutent qu'un redessin
 void	terminal_scroll()
 {
-	size_t	bytes_copy = (VGA_HEIGHT - 1) * VGA_WIDTH * sizeof(u16);	
-	ft_memcpy((void*)terminal_buffer, (void*)(terminal_buffer + VGA_WIDTH), bytes_copy);
+	TRACE(TRACE_SCROLL, term->top, term->history);
+	term->top = (term->top + 1) & SCROLLBACK_MASK;
+	if (term->history < SCROLLBACK_LINES - term_rows)
+		term->history++;
+	// Garde la vue sur le meme texte si l'on est en train de remonter.
+	// Sinon (vue du bas, ou deja sur la plus vieille ligne gardee) la
+	// fenetre affichee a bouge avec top: tout est a redessiner.
+	if (term->view_offset && term->view_offset < term->history)
+		term->view_offset++;
+	else
+		terminal_mark_dirty_all();
+	ft_memset16(terminal_line(term_rows - 1), vga_entry(' ', term->color), TERM_MAX_COLS);
+	term->row = term_rows - 1;
+	term->column = 0;
+}
+
+// Version publique de terminal_scroll, verrou pris
+void	terminal_scroll_lines(size_t lines)
+{
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	while (lines--)
+		terminal_scroll();
+	spin_unlock_irqrestore(&terminal_lock, flags);
+}
+
+void	terminal_save(t_terminal_state *state)
+{
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	state->screen = current_screen;
+	state->row = term->row;
+	state->column = term->column;
+	state->top = term->top;
+	state->history = term->history;
+	state->view_offset = term->view_offset;
+	spin_unlock_irqrestore(&terminal_lock, flags);
+}
+
+// Chaque scroll depuis la sauvegarde a efface une ligne au-dela de la
+// fenetre vivante, soit la plus vieille de l'historique: elles sont perdues
+void	terminal_restore(const t_terminal_state *state)
+{
+	u32		flags;
+	size_t	scrolled;
+	size_t	keep;
+
+	switch_screen(state->screen);
+	flags = spin_lock_irqsave(&terminal_lock);
+	scrolled = (term->top - state->top) & SCROLLBACK_MASK;
+	keep = SCROLLBACK_LINES - term_rows;
+	keep = scrolled < keep ? keep - scrolled : 0;
+	term->row = state->row;
+	term->column = state->column;
+	term->top = state->top;
+	term->history = state->history < keep ? state->history : keep;
+	term->view_offset = state->view_offset < term->history ? state->view_offset : term->history;
+	terminal_mark_dirty_all();
+	spin_unlock_irqrestore(&terminal_lock, flags);
+	terminal_flush();
+}
 
-	size_t	x = 0;
-	while (x < VGA_WIDTH)
+void	terminal_scroll_view(int lines)
+{
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+	int	offset = (int)term->view_offset + lines;
+
+	if (offset < 0)
+		offset = 0;
+	if (offset > (int)term->history)
+		offset = term->history;
+	if ((size_t)offset != term->view_offset)
 	{
-		size_t	index = (VGA_HEIGHT - 1) * VGA_WIDTH + x;
-		terminal_buffer[index] = vga_entry(' ', terminal_color);
-		++x;
+		term->view_offset = offset;
+		terminal_mark_dirty_all();
 	}
-	terminal_row = VGA_HEIGHT - 1;
-	terminal_column = 0;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
 void	terminal_putchar(char c)
 {
+	TRACE(TRACE_PUTCHAR, c, (term->row << 16) | term->column);
 	if (c == NEWLINE)
 	{
-		terminal_row++;
-		terminal_column = 0;
+		term->row++;
+		term->column = 0;
 
-		if (terminal_row >= VGA_HEIGHT)
+		if (term->row >= term_rows)
 			terminal_scroll();
-
-		set_cursor(terminal_row, terminal_column);
 	}
 	else
 	{
-		terminal_putentry(c, terminal_color, terminal_column, terminal_row);
-		++terminal_column;
+		terminal_putentry(c, term->color, term->column, term->row);
+		++term->column;
 
-		size_t max_col = (terminal_row == 0) ? (VGA_WIDTH - 14) : VGA_WIDTH;
+		size_t max_col = (term->row == 0) ? (term_cols - 14) : term_cols;
 		
-		if (terminal_column >= max_col)
+		if (term->column >= max_col)
+		{
+			term->column = 0;
+			++term->row;
+			if (term->row >= term_rows)
+				terminal_scroll();
+		}
+	}
+}
+
+// Pose les caracteres par morceaux de ligne: un marquage dirty et un test
+// de retour a la ligne par morceau au lieu d'un terminal_putchar par octet
+static void	terminal_write_locked(const char *data, size_t size)
+{
+	size_t	index = 0;
+
+	while (index < size)
+	{
+		if (data[index] == NEWLINE)
+		{
+			terminal_putchar(NEWLINE);
+			++index;
+			continue ;
+		}
+
+		size_t	max_col = (term->row == 0) ? (term_cols - 14) : term_cols;
+		u16		*line = terminal_line(term->row);
+		size_t	run = 0;
+
+		TRACE(TRACE_PUTCHAR, data[index], (term->row << 16) | term->column);
+		while (term->column + run < max_col && index + run < size && data[index + run] != NEWLINE)
+		{
+			line[term->column + run] = vga_entry(data[index + run], term->color);
+			++run;
+		}
+		if (run)
+			terminal_mark_live(term->column, term->row, run);
+		term->column += run;
+		index += run;
+		if (term->column >= max_col)
 		{
-			terminal_column = 0;
-			++terminal_row;
-			if (terminal_row >= VGA_HEIGHT)
+			term->column = 0;
+			++term->row;
+			if (term->row >= term_rows)
 				terminal_scroll();
 		}
-		set_cursor(terminal_row, terminal_column);
 	}
 }
 
 void	terminal_write(const char *data, size_t size)
 {
-    for (size_t i = 0; i < size; i++)
-        terminal_putchar(data[i]);
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	terminal_write_locked(data, size);
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
 void	clear_line()
 {
+	u32		flags = spin_lock_irqsave(&terminal_lock);
 	size_t	x = PROMPT_LENGTH;
-	while (x < VGA_WIDTH)
+
+	while (x < term_cols)
 	{
-		terminal_putentry(' ', terminal_color, x, terminal_row);
+		terminal_putentry(' ', term->color, x, term->row);
 		++x;
 	}
-	terminal_column = PROMPT_LENGTH;
-	set_cursor(terminal_row, terminal_column);
+	term->column = PROMPT_LENGTH;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 	print_prompt();
 }
 
 void	handle_ctrl_c()
 {
-	u8	old_color = terminal_color;
-
-	terminal_set_color(vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK));	
-	terminal_putentry('^', terminal_color, terminal_column, terminal_row);
-	terminal_column++;
-	terminal_putentry('C', terminal_color, terminal_column, terminal_row);
-	terminal_column++;
+	u32	flags;
+	u8	old_color;
+
+	terminal_scroll_view(-SCROLLBACK_LINES);
+	log_drain();
+	flags = spin_lock_irqsave(&terminal_lock);
+	old_color = term->color;
+	term->color = vga_entry_color(VGA_COLOR_LIGHT_RED2, VGA_COLOR_BLACK);
+	terminal_putentry('^', term->color, term->column, term->row);
+	term->column++;
+	terminal_putentry('C', term->color, term->column, term->row);
+	term->column++;
 	
-	terminal_set_color(old_color);
-	terminal_column = 0;
-	terminal_row++;
+	term->color = old_color;
+	term->column = 0;
+	term->row++;
 	
-	if (terminal_row >= VGA_HEIGHT)
+	if (term->row >= term_rows)
 		terminal_scroll();
-	
+	term->input_end = PROMPT_LENGTH;
+	spin_unlock_irqrestore(&terminal_lock, flags);
+
 	print_prompt();
-	input_end = PROMPT_LENGTH;
 }
 
 void	handle_backspace()
 {
-	if (terminal_column > PROMPT_LENGTH)
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	if (term->column > PROMPT_LENGTH)
 	{
-		--input_len;
-		input_buffer[input_len] = 0;
+		--term->input_len;
+		term->input_buffer[term->input_len] = 0;
 
-		--terminal_column;
-		terminal_putentry(' ', terminal_color, terminal_column, terminal_row);
-		set_cursor(terminal_row, terminal_column);
+		--term->column;
+		terminal_putentry(' ', term->color, term->column, term->row);
 	
-		if (terminal_column < input_end)
-			input_end = terminal_column;
+		if (term->column < term->input_end)
+			term->input_end = term->column;
 	}
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
 void	handle_ctrl_l()
 {
+	terminal_scroll_view(-SCROLLBACK_LINES);
 	terminal_clear_screen();
 	print_prompt();
-	input_end = PROMPT_LENGTH;
+
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	term->input_end = PROMPT_LENGTH;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
 void	handle_regular_char(char c)
 {
+	u32	flags;
+
 	if (caps_lock && c >= 'a' && c <= 'z')
 		c -= 32;
 
-	input_buffer[input_len++] = c;
-	input_buffer[input_len] = 0;
+	flags = spin_lock_irqsave(&terminal_lock);
+	term->input_buffer[term->input_len++] = c;
+	term->input_buffer[term->input_len] = 0;
 
 	terminal_putchar(c);
 
-	if (terminal_column > input_end)
-		input_end = terminal_column;
+	if (term->column > term->input_end)
+		term->input_end = term->column;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
 void	handle_enter()
 {
-	terminal_putchar('\n');
-	execute_command(input_buffer);
-	ft_memset(input_buffer, 0, sizeof(input_buffer));
-	input_len = 0;
+	terminal_write("\n", 1);
+	execute_command(term->input_buffer);
+	arena_reset(&command_arena);
+
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
+	ft_memset(term->input_buffer, 0, sizeof(term->input_buffer));
+	term->input_len = 0;
+	term->input_end = PROMPT_LENGTH;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 	print_prompt();
-	input_end = PROMPT_LENGTH;
 }
 
 void	process_scancode(u8 scancode)
 {
 	char c;
 	
+	terminal_scroll_view(-SCROLLBACK_LINES);
 	if (scancode == ENTER)
 	{
 		handle_enter();
@@ -286,146 +580,155 @@ void	handle_switch_terminal(u8 scancode)
 		size_t	new_screen = (current_screen + 1) % NUM_SCREENS;
 		switch_screen(new_screen);
 	}
+	else if (alt_pressed && scancode >= KEY_F1 && scancode < KEY_F1 + NUM_SCREENS)
+		switch_screen(scancode - KEY_F1);
 }
 
 void	arrow_handler(u8 scancode)
 {
+	u32	flags = spin_lock_irqsave(&terminal_lock);
+
 	if (scancode == LEFT_ARROW)
 	{
-		if (terminal_column > PROMPT_LENGTH)
-		{
-			--terminal_column;
-			set_cursor(terminal_row, terminal_column);
-		}
+		if (term->column > PROMPT_LENGTH)
+			--term->column;
 	}
 	else if (scancode == RIGHT_ARROW)
 	{
-		if (terminal_column < input_end && terminal_column < VGA_WIDTH - 1)
-		{
-			++terminal_column;
-			set_cursor(terminal_row, terminal_column);
-		}
+		if (term->column < term->input_end && term->column < term_cols - 1)
+			++term->column;
 	}
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
+void	handle_scancode(u8 scancode)
+{
+	bool is_extended = extended;
+
+	extended = (scancode == EXTENDED_PREFIX);
+	// Shift factice (E0 2A / E0 AA) envoye autour de PgUp/PgDn
+	if (is_extended && (scancode == SHIFT_LEFT || scancode == SHIFT_LEFT_R))
+		return ;
+	
+	handle_switch_terminal(scancode);
+	if (!alt_pressed && (scancode == RIGHT_ARROW || scancode == LEFT_ARROW))
+		arrow_handler(scancode);
+	else if (scancode == CTRL_PRESS)
+		ctrl_pressed = true;
+	else if (scancode == CTRL_RELEASE)
+		ctrl_pressed = false;
+	else if (ctrl_pressed && scancode == KEY_C)
+		handle_ctrl_c();
+	else if (ctrl_pressed && scancode == KEY_L)
+		handle_ctrl_l();
+	else if (scancode == SHIFT_LEFT || scancode == SHIFT_RIGHT)
+		shift_pressed = true;
+	else if (scancode == SHIFT_LEFT_R || scancode == SHIFT_RIGHT_R)
+		shift_pressed = false;
+	else if (scancode == CAPS_LOCK)
+		caps_lock = !caps_lock;
+	else if (shift_pressed && scancode == PAGE_UP)
+		terminal_scroll_view(term_rows - 1);
+	else if (shift_pressed && scancode == PAGE_DOWN)
+		terminal_scroll_view(-(int)(term_rows - 1));
+	else if (scancode < 128 && !ctrl_pressed)
+		process_scancode(scancode);
+}
+
+// Les scancodes arrivent par IRQ1; sans travail le CPU dort sur hlt
 void	keyboard_handler_loop()
 {
+	u8	scancode;
+
 	while (1)
 	{
-		if (inb(0x64) & 1)
+		// L'echo des touches passe apres les messages deja journalises
+		log_drain();
+		while (keyboard_pop(&scancode))
 		{
-			u8 scancode = inb(0x60);
-			
-			handle_switch_terminal(scancode);
-			if (!alt_pressed && (scancode == RIGHT_ARROW || scancode == LEFT_ARROW))
-				arrow_handler(scancode);
-			else if (scancode == CTRL_PRESS)
-				ctrl_pressed = true;
-			else if (scancode == CTRL_RELEASE)
-				ctrl_pressed = false;
-			else if (ctrl_pressed && scancode == KEY_C)
-				handle_ctrl_c();
-			else if (ctrl_pressed && scancode == KEY_L)
-				handle_ctrl_l();
-			else if (scancode == SHIFT_LEFT || scancode == SHIFT_RIGHT)
-				shift_pressed = true;
-			else if (scancode == SHIFT_LEFT_R || scancode == SHIFT_RIGHT_R)
-				shift_pressed = false;
-			else if (scancode == CAPS_LOCK)
-				caps_lock = !caps_lock;
-			else if (scancode < 128 && !ctrl_pressed)
-				process_scancode(scancode);
+			TRACE(TRACE_SCANCODE_BEGIN, scancode, 0);
+			handle_scancode(scancode);
+			TRACE(TRACE_SCANCODE_END, scancode, 0);
 		}
+		terminal_flush();
+		keyboard_wait();
 	}
 }
 
 void	terminal_write_string(const char *data)
 {
-	size_t i = 0;
-	while (data[i])
-	{
-		if (data[i] == '\n')
-			terminal_putchar('\n');
-		else
-			terminal_putchar(data[i]);
-		i++;
-	}
+	terminal_write(data, ft_strlen(data));
 }
 
 void	print_prompt()
 {
-	u8 old_color = terminal_color;
-	terminal_set_color(vga_entry_color(VGA_COLOR_LIGHT_GREY, VGA_COLOR_BLACK));
-	size_t i = 0;
-	const char *prompt = "kfs-2 -> ";
-	while (prompt[i])
-	{
-		terminal_putchar(prompt[i]);
-		i++;
-	}
-	terminal_set_color(old_color);
-	draw_screen_index();
-	set_cursor(terminal_row, PROMPT_LENGTH);
-}
-
-void	save_screen(size_t screen_id) 
-{
-	if (screen_id >= NUM_SCREENS)
-		return ;
-
-	ft_memcpy(screens[screen_id].save_buffer, (void*)terminal_buffer,
-		   VGA_WIDTH * VGA_HEIGHT * sizeof(u16));
-
-	screens[screen_id].save_row = terminal_row;
-	screens[screen_id].save_column = terminal_column;
-	screens[screen_id].save_input_end = input_end;
-	screens[screen_id].save_color = terminal_color;
-}
-
-void	load_screen(size_t screen_id)
-{
-	if (screen_id >= NUM_SCREENS)
-		return ;
-
-	ft_memcpy((void*)terminal_buffer, screens[screen_id].save_buffer,
-		   VGA_WIDTH * VGA_HEIGHT * sizeof(u16));
-
-	terminal_row = screens[screen_id].save_row;
-	terminal_column = screens[screen_id].save_column;
-	input_end = screens[screen_id].save_input_end;
-	terminal_color = screens[screen_id].save_color;
-	if (terminal_column == 0)
-		terminal_column = PROMPT_LENGTH;
-	set_cursor(terminal_row, terminal_column);
+	u32	flags;
+	u8	old_color;
+
+	log_drain();
+	flags = spin_lock_irqsave(&terminal_lock);
+	old_color = term->color;
+	term->color = vga_entry_color(VGA_COLOR_LIGHT_GREY, VGA_COLOR_BLACK);
+	terminal_write_locked("kfs-2 -> ", PROMPT_LENGTH);
+	term->color = old_color;
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
+// La page de l'ecran cible est deja a jour: changer d'ecran ne copie rien,
+// on change juste le pointeur courant et l'adresse de debut du CRTC.
+// Le framebuffer n'a qu'une page: on le redessine, seules les cellules
+// qui different sont reecrites.
 void	switch_screen(size_t new_screen_id)
 {
 	if (new_screen_id >= NUM_SCREENS || new_screen_id == current_screen)
 		return ;
 	
-	save_screen(current_screen);
-	current_screen = new_screen_id;
-	load_screen(new_screen_id);
+	TRACE(TRACE_SWITCH, current_screen, new_screen_id);
+	terminal_flush();
+
+	u32		flags = spin_lock_irqsave(&terminal_lock);
+	bool	repaint;
 
-	draw_screen_index();
+	current_screen = new_screen_id;
+	term = &screens[new_screen_id];
+	if (term->column == 0)
+		term->column = PROMPT_LENGTH;
+	repaint = fb_enabled() || !term->painted;
+	if (repaint)
+		terminal_mark_dirty_all();
+	term->painted = true;
+	spin_unlock_irqrestore(&terminal_lock, flags);
+
+	if (repaint)
+		terminal_flush();
+	if (fb_enabled())
+		return ;
+	flags = spin_lock_irqsave(&terminal_lock);
+	set_display_start(term->page_start);
+	spin_unlock_irqrestore(&terminal_lock, flags);
 }
 
+// Dessine par-dessus la ligne 0 affichee, sans passer par l'historique
 void	draw_screen_index()
 {
 	const char	*text = "Screen  /  ";
-	size_t		start_x = VGA_WIDTH - 13;
+	size_t		start_x = term_cols - 13;
 	u8			color = vga_entry_color(VGA_COLOR_WHITE, VGA_COLOR_BLACK);
+	u16			cells[11];
 
 	for (size_t	index = 0; text[index]; ++index)
 	{
 		if (index == 7)
-			terminal_buffer[start_x + index] = vga_entry('1' + current_screen, color);
+			cells[index] = vga_entry('1' + current_screen, color);
 		else if (index == 9)
-			terminal_buffer[start_x + index] = vga_entry('0' + NUM_SCREENS, color);
+			cells[index] = vga_entry('0' + NUM_SCREENS, color);
 		else
-			terminal_buffer[start_x + index] = vga_entry(text[index], color);
+			cells[index] = vga_entry(text[index], color);
 	}
+	if (fb_enabled())
+		fb_draw_cells(start_x, 0, cells, 11);
+	else
+		ft_memcpy((void *)(term->page + start_x), cells, sizeof(cells));
 }
 
 void	need_help(void)
@@ -435,11 +738,56 @@ void	need_help(void)
 	terminal_set_color(VGA_COLOR_LIGHT_RED2);
 }
 
-void	kernel_main(void)
+void	kernel_main(u32 magic, void *info)
 {
 	terminal_initialize();
+	boot_stage("terminal");
 	gdt_init();
+	boot_stage("gdt");
+	idt_init();
+	boot_stage("idt");
+	if (magic == MULTIBOOT_BOOTLOADER_MAGIC)
+		pmm_init(info);
+	else if (magic == MULTIBOOT2_BOOTLOADER_MAGIC)
+		pmm_init_multiboot2(info);
+	else
+		printk(KERN_ERR "Bad multiboot magic 0x%x, no physical memory\n", magic);
+	boot_stage("pmm");
+	paging_init();
+	boot_stage("paging");
+	// Le framebuffer est identity-mappe par fb_init: apres paging_init
+	if (magic == MULTIBOOT2_BOOTLOADER_MAGIC
+		&& fb_init((const t_multiboot2_tag_framebuffer *)multiboot2_find_tag(info, MULTIBOOT2_TAG_FRAMEBUFFER)))
+	{
+		terminal_set_framebuffer(fb_text_columns(), fb_text_rows());
+		boot_stage("framebuffer");
+	}
+	kmalloc_init();
+	timer_init();
+	serial_init();
+	keyboard_init();
+	shell_init();
+	asm volatile ("sti");
+	boot_stage("drivers");
+	// Les delais INIT/SIPI passent par le timer: apres sti
+	smp_init();
+	boot_stage("smp");
 	need_help();
 	print_prompt();
+	terminal_flush();
+	boot_stage("prompt");
+
+#ifdef BENCH_MODE
+	// make bench: rapport complet sur COM1, puis extinction de QEMU
+	print_boot_stages();
+	// Le temps jusqu'au prompt est suivi comme un cas de mesure a part entiere
+	printk("BENCH name=boot_kcycles runs=1 min=%u median=%u p99=%u\n",
+		boot_total_kcycles(), boot_total_kcycles(), boot_total_kcycles());
+	bench_all();
+	printk("BENCH done\n");
+	log_drain();
+	serial_flush();
+	outw(0x604, 0x2000);
+#endif
 	keyboard_handler_loop();
 }
@@ -0,0 +1,65 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   keyboard.c                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/24 15:12:44 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/24 18:37:45 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/keyboard.h"
+#include "../includes/idt.h"
+#include "../includes/trace.h"
+#include "../includes/io.h"
+
+// File mono-producteur (IRQ1) / mono-consommateur (boucle du shell):
+// seul l'IRQ ecrit head, seule la boucle ecrit tail, pas besoin de verrou
+static u8			queue[KEYBOARD_QUEUE_SIZE];
+static volatile u8	queue_head = 0;
+static volatile u8	queue_tail = 0;
+
+static void	keyboard_irq(t_registers *regs)
+{
+	u8	scancode = inb(KEYBOARD_DATA_PORT);
+	u8	next = queue_head + 1;
+
+	(void)regs;
+	TRACE(TRACE_KEYBOARD_IRQ, scancode, (u8)(queue_head - queue_tail));
+	// File pleine: on perd la touche plutot que d'ecraser la plus ancienne
+	if (next == queue_tail)
+		return ;
+	queue[queue_head] = scancode;
+	asm volatile ("" ::: "memory");
+	queue_head = next;
+}
+
+void	keyboard_init(void)
+{
+	while (inb(KEYBOARD_STATUS_PORT) & 1)
+		inb(KEYBOARD_DATA_PORT);
+	irq_register_handler(IRQ_KEYBOARD, keyboard_irq);
+}
+
+bool	keyboard_pop(u8 *scancode)
+{
+	if (queue_tail == queue_head)
+		return (false);
+	*scancode = queue[queue_tail];
+	asm volatile ("" ::: "memory");
+	queue_tail = queue_tail + 1;
+	return (true);
+}
+
+// sti ne prend effet qu'apres l'instruction suivante: une IRQ arrivee entre
+// le test et le hlt reveille quand meme le CPU
+void	keyboard_wait(void)
+{
+	asm volatile ("cli");
+	if (queue_tail == queue_head)
+		asm volatile ("sti; hlt");
+	else
+		asm volatile ("sti");
+}
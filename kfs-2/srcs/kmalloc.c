@@ -0,0 +1,397 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   kmalloc.c                                          :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/29 09:47:31 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/29 18:12:40 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/kmalloc.h"
+#include "../includes/kernel.h"
+#include "../includes/io.h"
+#include "../includes/lock.h"
+
+// En-tete en debut de chaque page de slab: kfree le retrouve en arrondissant
+// le pointeur a la page, sans table de correspondance
+typedef struct s_slab
+{
+	struct s_slab_cache	*cache;
+	struct s_slab		*next;
+	struct s_slab		*prev;
+	void				*free;
+	u32					in_use;
+}	t_slab;
+
+typedef struct s_slab_cache
+{
+	u32		object_size;
+	u32		first_offset;
+	u32		per_slab;
+	t_slab	*partial;
+	u32		slabs;
+	u32		in_use;
+	u32		allocs;
+	u32		frees;
+}	t_slab_cache;
+
+typedef struct s_range
+{
+	u32	start;
+	u32	end;
+}	t_range;
+
+static t_slab_cache	caches[KMALLOC_CACHES];
+
+// Plages libres de la zone a la demande, triees et fusionnees
+static t_range		free_ranges[KMALLOC_RANGES_MAX];
+static u32			range_count = 0;
+static u32			large_live = 0;
+static u32			large_pages = 0;
+
+// Caches et plages: les IRQ comme les autres CPUs peuvent allouer
+static t_spinlock	heap_lock = SPINLOCK_INIT("heap");
+
+t_arena				command_arena;
+
+static u32	cache_index(size_t size)
+{
+	if (size <= (1 << KMALLOC_MIN_SHIFT))
+		return (0);
+	return (32 - __builtin_clz(size - 1) - KMALLOC_MIN_SHIFT);
+}
+
+static t_slab	*slab_create(t_slab_cache *cache)
+{
+	t_slab	*slab = (t_slab *)pmm_alloc_frame();
+
+	if (!slab)
+		return (NULL);
+	slab->cache = cache;
+	slab->next = NULL;
+	slab->prev = NULL;
+	slab->in_use = 0;
+
+	// Chaine les objets libres dans l'ordre des adresses
+	u8	*object = (u8 *)slab + cache->first_offset;
+
+	slab->free = object;
+	for (u32 index = 1; index < cache->per_slab; ++index, object += cache->object_size)
+		*(void **)object = object + cache->object_size;
+	*(void **)object = NULL;
+
+	++cache->slabs;
+	return (slab);
+}
+
+static void	slab_unlink(t_slab *slab)
+{
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		slab->cache->partial = slab->next;
+	if (slab->next)
+		slab->next->prev = slab->prev;
+	slab->next = NULL;
+	slab->prev = NULL;
+}
+
+static void	slab_push(t_slab *slab)
+{
+	slab->prev = NULL;
+	slab->next = slab->cache->partial;
+	if (slab->next)
+		slab->next->prev = slab;
+	slab->cache->partial = slab;
+}
+
+static void	*slab_alloc(t_slab_cache *cache)
+{
+	t_slab	*slab = cache->partial;
+
+	if (!slab)
+	{
+		slab = slab_create(cache);
+		if (!slab)
+			return (NULL);
+		slab_push(slab);
+	}
+
+	void	*object = slab->free;
+
+	slab->free = *(void **)object;
+	++slab->in_use;
+	// Plein: il sort de la liste et n'y revient qu'au prochain kfree
+	if (!slab->free)
+		slab_unlink(slab);
+	++cache->in_use;
+	++cache->allocs;
+	return (object);
+}
+
+static void	slab_free(void *ptr)
+{
+	t_slab			*slab = (t_slab *)PAGE_ALIGN_DOWN((u32)ptr);
+	t_slab_cache	*cache = slab->cache;
+
+	if (!slab->free)
+		slab_push(slab);
+	*(void **)ptr = slab->free;
+	slab->free = ptr;
+	--slab->in_use;
+	--cache->in_use;
+	++cache->frees;
+
+	// Slab vide: rendu au pmm, sauf s'il est le seul a servir le cache
+	if (slab->in_use == 0 && (slab->prev || slab->next))
+	{
+		slab_unlink(slab);
+		pmm_free_frame((u32)slab);
+		--cache->slabs;
+	}
+}
+
+// Premiere plage assez grande, consommee par le debut
+static u32	range_alloc(u32 size)
+{
+	for (u32 index = 0; index < range_count; ++index)
+	{
+		if (free_ranges[index].end - free_ranges[index].start < size)
+			continue ;
+
+		u32	start = free_ranges[index].start;
+
+		free_ranges[index].start += size;
+		if (free_ranges[index].start == free_ranges[index].end)
+		{
+			--range_count;
+			ft_memmove(&free_ranges[index], &free_ranges[index + 1],
+				(range_count - index) * sizeof(t_range));
+		}
+		return (start);
+	}
+	return (0);
+}
+
+static void	range_free(u32 start, u32 end)
+{
+	u32	index = 0;
+
+	while (index < range_count && free_ranges[index].start < start)
+		++index;
+
+	bool	merge_prev = index > 0 && free_ranges[index - 1].end == start;
+	bool	merge_next = index < range_count && free_ranges[index].start == end;
+
+	if (merge_prev && merge_next)
+	{
+		free_ranges[index - 1].end = free_ranges[index].end;
+		--range_count;
+		ft_memmove(&free_ranges[index], &free_ranges[index + 1],
+			(range_count - index) * sizeof(t_range));
+	}
+	else if (merge_prev)
+		free_ranges[index - 1].end = end;
+	else if (merge_next)
+		free_ranges[index].start = start;
+	else if (range_count < KMALLOC_RANGES_MAX)
+	{
+		ft_memmove(&free_ranges[index + 1], &free_ranges[index],
+			(range_count - index) * sizeof(t_range));
+		free_ranges[index].start = start;
+		free_ranges[index].end = end;
+		++range_count;
+	}
+	// Table pleine: la plage d'adresses est perdue, pas la memoire physique
+}
+
+// Seule l'adresse virtuelle est reservee: les pages arrivent au premier
+// acces via le page fault, deja remplies de zeros
+static void	*large_alloc(size_t size)
+{
+	u32	bytes = PAGE_ALIGN_UP(size + KMALLOC_LARGE_HEADER);
+	u32	base;
+
+	if (size > PAGING_DEMAND_END - PAGING_DEMAND_START)
+		return (NULL);
+	base = range_alloc(bytes);
+	if (!base)
+		return (NULL);
+	*(u32 *)base = bytes;
+	++large_live;
+	large_pages += bytes / PAGE_SIZE;
+	return ((void *)(base + KMALLOC_LARGE_HEADER));
+}
+
+static void	large_free(void *ptr)
+{
+	u32	base = (u32)ptr - KMALLOC_LARGE_HEADER;
+	u32	bytes = *(u32 *)base;
+
+	for (u32 page = base; page < base + bytes; page += PAGE_SIZE)
+	{
+		u32	frame = paging_unmap_page(page);
+
+		if (frame)
+			pmm_free_frame(frame);
+	}
+	range_free(base, base + bytes);
+	--large_live;
+	large_pages -= bytes / PAGE_SIZE;
+}
+
+void	kmalloc_init(void)
+{
+	for (u32 index = 0; index < KMALLOC_CACHES; ++index)
+	{
+		t_slab_cache	*cache = &caches[index];
+
+		cache->object_size = 1 << (index + KMALLOC_MIN_SHIFT);
+		// Objets alignes sur leur taille, apres l'en-tete
+		cache->first_offset = cache->object_size < 32 ? 32 : cache->object_size;
+		cache->per_slab = (PAGE_SIZE - cache->first_offset) / cache->object_size;
+	}
+	free_ranges[0].start = PAGING_DEMAND_START;
+	free_ranges[0].end = PAGING_DEMAND_END;
+	range_count = 1;
+
+	arena_init(&command_arena, COMMAND_ARENA_SIZE);
+}
+
+void	*kmalloc(size_t size)
+{
+	void	*ptr;
+	u32		flags;
+
+	if (size == 0)
+		return (NULL);
+	flags = spin_lock_irqsave(&heap_lock);
+	if (size <= KMALLOC_MAX_SLAB_SIZE)
+		ptr = slab_alloc(&caches[cache_index(size)]);
+	else
+		ptr = large_alloc(size);
+	spin_unlock_irqrestore(&heap_lock, flags);
+	return (ptr);
+}
+
+void	*kzalloc(size_t size)
+{
+	void	*ptr = kmalloc(size);
+
+	// Les grandes allocations sortent deja a zero du page fault
+	if (ptr && size <= KMALLOC_MAX_SLAB_SIZE)
+		ft_memset(ptr, 0, size);
+	return (ptr);
+}
+
+void	kfree(void *ptr)
+{
+	u32	flags;
+
+	if (!ptr)
+		return ;
+	flags = spin_lock_irqsave(&heap_lock);
+	if ((u32)ptr >= PAGING_DEMAND_START && (u32)ptr < PAGING_DEMAND_END)
+		large_free(ptr);
+	else
+		slab_free(ptr);
+	spin_unlock_irqrestore(&heap_lock, flags);
+}
+
+bool	arena_init(t_arena *arena, size_t size)
+{
+	arena->base = kmalloc(size);
+	arena->size = arena->base ? size : 0;
+	arena->offset = 0;
+	arena->high_water = 0;
+	return (arena->base != NULL);
+}
+
+void	*arena_alloc(t_arena *arena, size_t size)
+{
+	size_t	offset = (arena->offset + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+	if (size > arena->size || offset > arena->size - size)
+		return (NULL);
+	arena->offset = offset + size;
+	if (arena->offset > arena->high_water)
+		arena->high_water = arena->offset;
+	return (arena->base + offset);
+}
+
+// Tout liberer d'un coup: les pages restent mappees pour la commande suivante
+void	arena_reset(t_arena *arena)
+{
+	arena->offset = 0;
+}
+
+# define HEAP_BENCH_OBJECTS	256
+
+static void	heap_latency(size_t size)
+{
+	static void	*objects[HEAP_BENCH_OBJECTS];
+	u32			alloc_total = 0;
+	u32			alloc_max = 0;
+	u32			free_total = 0;
+	u32			free_max = 0;
+	u32			count = 0;
+
+	while (count < HEAP_BENCH_OBJECTS)
+	{
+		u64		start = rdtsc();
+		void	*ptr = kmalloc(size);
+		u32		cycles = (u32)(rdtsc() - start);
+
+		if (!ptr)
+			break ;
+		objects[count++] = ptr;
+		alloc_total += cycles;
+		if (cycles > alloc_max)
+			alloc_max = cycles;
+	}
+	for (u32 index = 0; index < count; ++index)
+	{
+		u64	start = rdtsc();
+		kfree(objects[index]);
+		u32	cycles = (u32)(rdtsc() - start);
+
+		free_total += cycles;
+		if (cycles > free_max)
+			free_max = cycles;
+	}
+	if (count)
+		printk("%u B x%u: kmalloc avg %u max %u, kfree avg %u max %u cycles\n", size, count,
+			alloc_total / count, alloc_max, free_total / count, free_max);
+}
+
+void	print_heap(void)
+{
+	u32	largest = 0;
+
+	printk("size  slabs  objects  util  allocs/frees\n");
+	for (u32 index = 0; index < KMALLOC_CACHES; ++index)
+	{
+		t_slab_cache	*cache = &caches[index];
+
+		if (!cache->slabs)
+			continue ;
+		// Part des pages de slab reellement occupee par des objets vivants
+		printk("%u  %u  %u/%u  %u%%  %u/%u\n", cache->object_size, cache->slabs,
+			cache->in_use, cache->slabs * cache->per_slab,
+			cache->in_use * cache->object_size / cache->slabs * 100 / PAGE_SIZE,
+			cache->allocs, cache->frees);
+	}
+	for (u32 index = 0; index < range_count; ++index)
+		if (free_ranges[index].end - free_ranges[index].start > largest)
+			largest = free_ranges[index].end - free_ranges[index].start;
+	printk("large: %u live, %u pages reserved, %u free ranges, largest %u KB\n",
+		large_live, large_pages, range_count, largest / 1024);
+	printk("arena: %u/%u bytes peak\n", command_arena.high_water, command_arena.size);
+
+	heap_latency(32);
+	heap_latency(512);
+	heap_latency(3 * PAGE_SIZE);
+}
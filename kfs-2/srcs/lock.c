@@ -0,0 +1,259 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   lock.c                                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/16 09:41:55 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/17 16:22:08 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/lock.h"
+#include "../includes/kernel.h"
+#include "../includes/io.h"
+#include "../includes/shell.h"
+
+#ifdef KFS_LOCK_STATS
+static t_lock_stats	*registry[LOCK_REGISTRY_MAX];
+static u32			registry_count = 0;
+#endif
+
+static __inline__ u64	lock_clock(void)
+{
+#ifdef KFS_LOCK_STATS
+	return (rdtsc());
+#else
+	return (0);
+#endif
+}
+
+// Appele verrou tenu (ou, pour les lecteurs, avec des compteurs atomiques)
+static void	lock_acquired(t_lock_stats *stats, u64 wait_start, bool contended)
+{
+#ifdef KFS_LOCK_STATS
+	u64	now = rdtsc();
+
+	if (!__atomic_exchange_n(&stats->registered, true, __ATOMIC_RELAXED))
+	{
+		u32	slot = __atomic_fetch_add(&registry_count, 1, __ATOMIC_RELAXED);
+
+		if (slot < LOCK_REGISTRY_MAX)
+			registry[slot] = stats;
+	}
+	__atomic_fetch_add(&stats->acquires, 1, __ATOMIC_RELAXED);
+	if (contended)
+	{
+		__atomic_fetch_add(&stats->contended, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&stats->wait_cycles, now - wait_start, __ATOMIC_RELAXED);
+	}
+	stats->locked_at = now;
+#else
+	(void)stats;
+	(void)wait_start;
+	(void)contended;
+#endif
+}
+
+static void	lock_released(t_lock_stats *stats)
+{
+#ifdef KFS_LOCK_STATS
+	stats->hold_cycles += rdtsc() - stats->locked_at;
+#else
+	(void)stats;
+#endif
+}
+
+// cmpxchg seul, sans statistiques: la boucle de spin_lock les tient elle-meme
+static __inline__ bool	spin_try_raw(t_spinlock *lock)
+{
+	u32	expected = 0;
+
+	return (__atomic_compare_exchange_n(&lock->locked, &expected, 1, false,
+		__ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+}
+
+// Une prise reussie compte comme une prise sans attente: spin_unlock
+// mesure ensuite la duree de detention a partir de locked_at
+bool	spin_trylock(t_spinlock *lock)
+{
+	if (!spin_try_raw(lock))
+		return (false);
+	lock_acquired(&lock->stats, 0, false);
+	return (true);
+}
+
+void	spin_lock(t_spinlock *lock)
+{
+	u64	start;
+
+	if (spin_trylock(lock))
+		return ;
+	start = lock_clock();
+	do
+	{
+		// Attente en lecture seule: la ligne de cache reste partagee
+		// jusqu'a la liberation, un seul cmpxchg par tentative
+		while (lock->locked)
+			cpu_relax();
+	} while (!spin_try_raw(lock));
+	lock_acquired(&lock->stats, start, true);
+}
+
+void	spin_unlock(t_spinlock *lock)
+{
+	lock_released(&lock->stats);
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+// Chemin fatal seulement: le contexte interrompu ne rendra jamais ce verrou
+void	spin_force_unlock(t_spinlock *lock)
+{
+	__atomic_store_n(&lock->locked, 0, __ATOMIC_RELEASE);
+}
+
+// Pour ce qu'une IRQ peut aussi prendre: sans cli, l'IRQ tournerait a
+// l'infini sur un verrou tenu par le code qu'elle a interrompu
+u32	spin_lock_irqsave(t_spinlock *lock)
+{
+	u32	flags = irq_save();
+
+	spin_lock(lock);
+	return (flags);
+}
+
+void	spin_unlock_irqrestore(t_spinlock *lock, u32 flags)
+{
+	spin_unlock(lock);
+	irq_restore(flags);
+}
+
+void	ticket_lock(t_ticketlock *lock)
+{
+	u32	ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_ACQUIRE);
+	u64	start;
+
+	if (lock->serving == ticket)
+	{
+		lock_acquired(&lock->stats, 0, false);
+		return ;
+	}
+	start = lock_clock();
+	while (__atomic_load_n(&lock->serving, __ATOMIC_ACQUIRE) != ticket)
+		cpu_relax();
+	lock_acquired(&lock->stats, start, true);
+}
+
+// Seul le detenteur ecrit serving: un store suffit, pas besoin de lock
+void	ticket_unlock(t_ticketlock *lock)
+{
+	lock_released(&lock->stats);
+	__atomic_store_n(&lock->serving, lock->serving + 1, __ATOMIC_RELEASE);
+}
+
+u32	ticket_lock_irqsave(t_ticketlock *lock)
+{
+	u32	flags = irq_save();
+
+	ticket_lock(lock);
+	return (flags);
+}
+
+void	ticket_unlock_irqrestore(t_ticketlock *lock, u32 flags)
+{
+	ticket_unlock(lock);
+	irq_restore(flags);
+}
+
+// Les lecteurs tiennent le verrou a plusieurs: pas de temps de detention
+void	read_lock(t_rwlock *lock)
+{
+	u32		state = lock->state;
+	u64		start = 0;
+	bool	contended = false;
+
+	while ((state & RWLOCK_WRITER) || !__atomic_compare_exchange_n(&lock->state, &state,
+		state + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	{
+		if (!contended)
+			start = lock_clock();
+		contended = true;
+		cpu_relax();
+		state = lock->state;
+	}
+	lock_acquired(&lock->stats, start, contended);
+}
+
+void	read_unlock(t_rwlock *lock)
+{
+	__atomic_fetch_sub(&lock->state, 1, __ATOMIC_RELEASE);
+}
+
+// Prend d'abord le bit ecrivain, puis attend que les lecteurs deja
+// entres sortent: un flot de lecteurs ne bloque pas l'ecrivain
+void	write_lock(t_rwlock *lock)
+{
+	u32		state = lock->state;
+	u64		start = 0;
+	bool	contended = false;
+
+	while ((state & RWLOCK_WRITER) || !__atomic_compare_exchange_n(&lock->state, &state,
+		state | RWLOCK_WRITER, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+	{
+		if (!contended)
+			start = lock_clock();
+		contended = true;
+		cpu_relax();
+		state = lock->state;
+	}
+	if (state & RWLOCK_READERS)
+	{
+		if (!contended)
+			start = lock_clock();
+		contended = true;
+		while (__atomic_load_n(&lock->state, __ATOMIC_ACQUIRE) & RWLOCK_READERS)
+			cpu_relax();
+	}
+	lock_acquired(&lock->stats, start, contended);
+}
+
+void	write_unlock(t_rwlock *lock)
+{
+	lock_released(&lock->stats);
+	__atomic_store_n(&lock->state, 0, __ATOMIC_RELEASE);
+}
+
+// Les plus chauds d'abord: ceux qui ont fait attendre le plus de cycles
+static void	command_locks(const char *args)
+{
+	(void)args;
+#ifndef KFS_LOCK_STATS
+	printk("locks: statistics disabled (build with PROFILE=debug)\n");
+#else
+	t_lock_stats	*sorted[LOCK_REGISTRY_MAX];
+	u32				count = registry_count;
+
+	if (count > LOCK_REGISTRY_MAX)
+		count = LOCK_REGISTRY_MAX;
+	for (u32 index = 0; index < count; ++index)
+	{
+		u32	pos = index;
+
+		while (pos > 0 && sorted[pos - 1]->wait_cycles < registry[index]->wait_cycles)
+		{
+			sorted[pos] = sorted[pos - 1];
+			--pos;
+		}
+		sorted[pos] = registry[index];
+	}
+	terminal_set_color(VGA_COLOR_WHITE);
+	printk("%-12s %10s %10s %14s %14s\n", "lock", "acquires", "contended", "wait cycles", "hold cycles");
+	for (u32 index = 0; index < count && index < LOCK_TOP; ++index)
+		printk("%-12s %10u %10u %14llu %14llu\n", sorted[index]->name, sorted[index]->acquires,
+			sorted[index]->contended, sorted[index]->wait_cycles, sorted[index]->hold_cycles);
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+#endif
+}
+
+SHELL_COMMAND("locks", "locks", "hottest locks by wait time", command_locks);
@@ -0,0 +1,194 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   log.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/18 10:07:31 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/18 17:45:12 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/log.h"
+#include "../includes/kernel.h"
+#include "../includes/console.h"
+#include "../includes/lock.h"
+#include "../includes/io.h"
+#include "../includes/shell.h"
+
+typedef enum e_log_read
+{
+	LOG_READ_OK,
+	LOG_READ_PENDING,
+	LOG_READ_LOST
+}	t_log_read;
+
+// Un enregistrement par ligne de cache au moins: deux CPUs qui ecrivent
+// cote a cote ne se disputent pas la meme ligne
+static t_log_record	records[LOG_SLOTS] __attribute__((aligned(64)));
+// Prochain numero a reserver (producteurs) et prochain a rendre (drain)
+static u32			log_head = 0;
+static u32			log_tail = 0;
+static u32			log_lost = 0;
+// Un seul CPU rend le journal a la fois, les autres repartent aussitot
+static t_spinlock	drain_lock = SPINLOCK_INIT("log");
+
+// Producteur: un xadd reserve l'enregistrement, puis le texte est publie par
+// commit. Ni verrou ni materiel, utilisable depuis une IRQ ou un autre CPU.
+// Un drain en retard d'un tour complet perd les plus anciens.
+void	log_store(u8 level, const char *text, size_t len)
+{
+	u32				seq = __atomic_fetch_add(&log_head, 1, __ATOMIC_RELAXED);
+	t_log_record	*record = &records[seq & LOG_MASK];
+
+	if (len > LOG_TEXT_MAX)
+		len = LOG_TEXT_MAX;
+	__atomic_store_n(&record->commit, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	record->len = len;
+	record->level = level;
+	record->tsc = rdtsc();
+	ft_memcpy(record->text, text, len);
+	__atomic_store_n(&record->commit, seq + 1, __ATOMIC_RELEASE);
+}
+
+// Copie l'enregistrement seq, puis relit commit: s'il a change pendant la
+// copie, un producteur du tour suivant l'a ecrase
+static t_log_read	log_read(u32 seq, t_log_record *out)
+{
+	t_log_record	*record = &records[seq & LOG_MASK];
+	u32				commit = __atomic_load_n(&record->commit, __ATOMIC_ACQUIRE);
+
+	if (commit != seq + 1)
+		return ((i32)(commit - (seq + 1)) > 0 ? LOG_READ_LOST : LOG_READ_PENDING);
+	out->len = record->len;
+	if (out->len > LOG_TEXT_MAX)
+		out->len = LOG_TEXT_MAX;
+	out->level = record->level;
+	out->tsc = record->tsc;
+	ft_memcpy(out->text, record->text, out->len);
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&record->commit, __ATOMIC_RELAXED) != commit)
+		return (LOG_READ_LOST);
+	out->commit = commit;
+	return (LOG_READ_OK);
+}
+
+// Signale les trous avant le prochain message rendu
+static void	report_lost(void)
+{
+	char	line[32];
+	char	*start;
+
+	if (!log_lost)
+		return ;
+	ft_memcpy(line + 16, " records lost]\n", 15);
+	start = putnbr_dec(line + 16, log_lost);
+	*--start = '[';
+	console_write(start, line + 31 - start);
+	log_lost = 0;
+}
+
+// Rend les enregistrements publies, dans l'ordre, vers les consoles.
+// S'arrete sur le premier encore en cours d'ecriture: il sera rendu au
+// prochain appel.
+void	log_drain(void)
+{
+	t_log_record	record;
+	u32				head;
+
+	if (!spin_trylock(&drain_lock))
+		return ;
+	head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+	if (head - log_tail > LOG_SLOTS)
+	{
+		log_lost += head - LOG_SLOTS - log_tail;
+		log_tail = head - LOG_SLOTS;
+	}
+	while (log_tail != head)
+	{
+		t_log_read	status = log_read(log_tail, &record);
+
+		if (status == LOG_READ_PENDING)
+			break ;
+		if (status == LOG_READ_LOST)
+			++log_lost;
+		else
+		{
+			report_lost();
+			console_write(record.text, record.len);
+		}
+		++log_tail;
+	}
+	spin_unlock(&drain_lock);
+}
+
+// Handlers fatals, juste avant cli; hlt. Le contexte interrompu a pu garder
+// drain_lock, console_lock ou terminal_lock, ou laisser un enregistrement
+// reserve mais jamais publie: on force les verrous et on rend tout ce qui
+// est publie, sans attendre ni s'arreter sur les trous.
+void	log_panic(void)
+{
+	t_log_record	record;
+	u32				head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+
+	console_panic();
+	terminal_panic();
+	if (head - log_tail > LOG_SLOTS)
+	{
+		log_lost += head - LOG_SLOTS - log_tail;
+		log_tail = head - LOG_SLOTS;
+	}
+	// L'arriere garde sa couleur, seul le dernier (le message fatal) passe en blanc
+	for (; log_tail != head; ++log_tail)
+	{
+		if (log_read(log_tail, &record) != LOG_READ_OK)
+		{
+			++log_lost;
+			continue ;
+		}
+		report_lost();
+		if (log_tail + 1 == head)
+		{
+			// log_tail avance d'abord: le drain de terminal_set_color n'a plus rien a rendre
+			++log_tail;
+			terminal_set_color(VGA_COLOR_WHITE);
+			console_write(record.text, record.len);
+			break ;
+		}
+		console_write(record.text, record.len);
+	}
+	report_lost();
+	terminal_flush();
+}
+
+u32	log_pending(void)
+{
+	return (__atomic_load_n(&log_head, __ATOMIC_RELAXED) - log_tail);
+}
+
+// Relit les derniers enregistrements encore dans l'anneau, deja rendus ou non
+static void	command_dmesg(const char *args)
+{
+	t_log_record	record;
+	u32				head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+	u32				seq = head < LOG_DMESG ? 0 : head - LOG_DMESG;
+
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	for (; seq != head; ++seq)
+	{
+		if (log_read(seq, &record) != LOG_READ_OK)
+			continue ;
+		if (record.len && record.text[record.len - 1] == '\n')
+			--record.len;
+		if (record.len == LOG_TEXT_MAX)
+			--record.len;
+		record.text[record.len] = '\0';
+		printk("%6u <%u> %14llu %s\n", seq, record.level, record.tsc - boot_tsc, record.text);
+	}
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+SHELL_COMMAND("dmesg", "dmesg", "last log records: seq, level, cycles", command_dmesg);
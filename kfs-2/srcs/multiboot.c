@@ -0,0 +1,33 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   multiboot.c                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/09 10:05:33 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/09 10:41:57 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/multiboot.h"
+
+// Premier tag du type demande, NULL si le chargeur ne l'a pas fourni
+const t_multiboot2_tag	*multiboot2_find_tag(const t_multiboot2_info *info, u32 type)
+{
+	const u8	*addr = (const u8 *)info + sizeof(*info);
+	const u8	*end = (const u8 *)info + info->total_size;
+
+	while (addr < end)
+	{
+		const t_multiboot2_tag	*tag = (const t_multiboot2_tag *)addr;
+
+		// Taille nulle ou tronquee: on n'avancerait plus
+		if (tag->type == MULTIBOOT2_TAG_END || tag->size < sizeof(t_multiboot2_tag))
+			break ;
+		if (tag->type == type)
+			return (tag);
+		addr += (tag->size + 7) & ~7;
+	}
+	return (NULL);
+}
@@ -0,0 +1,239 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   paging.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/28 10:03:17 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/28 16:40:12 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/paging.h"
+#include "../includes/kernel.h"
+#include "../includes/log.h"
+#include "../includes/idt.h"
+
+extern u32	_kernel_end;
+
+static u32	page_directory[PAGE_ENTRIES] __attribute__((aligned(PAGE_SIZE)));
+
+static bool	large_pages = false;
+static u32	global_flag = 0;
+static u32	identity_end = 0;
+static u32	page_tables = 0;
+static u32	demand_faults = 0;
+
+static u32	cpuid_edx(void)
+{
+	u32	eax = 1;
+	u32	ebx;
+	u32	ecx;
+	u32	edx;
+
+	__asm__ volatile ("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+
+	return (edx);
+}
+
+// Table de pages pour la PDE de virt, creee (a zero) si besoin. Les frames
+// du pmm sont dans la zone identite, on y accede donc par leur adresse.
+static u32	*get_page_table(u32 virt, u32 flags, bool create)
+{
+	u32	*pde = &page_directory[virt >> PAGE_LARGE_SHIFT];
+
+	if (*pde & PAGE_PRESENT)
+	{
+		if (*pde & PAGE_LARGE)
+			return (NULL);
+		return ((u32 *)PAGE_ALIGN_DOWN(*pde));
+	}
+	if (!create)
+		return (NULL);
+
+	u32	frame = pmm_alloc_frame();
+
+	if (!frame)
+		return (NULL);
+	ft_memset32((u32 *)frame, 0, PAGE_ENTRIES);
+	*pde = frame | PAGE_PRESENT | PAGE_WRITE | (flags & PAGE_USER);
+	++page_tables;
+	return ((u32 *)frame);
+}
+
+bool	paging_map_page(u32 virt, u32 phys, u32 flags)
+{
+	u32	*table = get_page_table(virt, flags, true);
+
+	if (!table)
+		return (false);
+	table[(virt >> PAGE_SHIFT) & (PAGE_ENTRIES - 1)] = PAGE_ALIGN_DOWN(phys) | flags | PAGE_PRESENT;
+	// Une seule entree a changer: pas besoin de recharger CR3
+	invlpg(virt);
+	return (true);
+}
+
+// Retire la page et renvoie le frame qui y etait mappe (0 si aucun)
+u32	paging_unmap_page(u32 virt)
+{
+	u32	*table = get_page_table(virt, 0, false);
+
+	if (!table)
+		return (0);
+
+	u32	*pte = &table[(virt >> PAGE_SHIFT) & (PAGE_ENTRIES - 1)];
+	u32	phys = PAGE_ALIGN_DOWN(*pte);
+
+	if (!(*pte & PAGE_PRESENT))
+		return (0);
+	*pte = 0;
+	invlpg(virt);
+	return (phys);
+}
+
+u32	paging_get_physical(u32 virt)
+{
+	u32	pde = page_directory[virt >> PAGE_LARGE_SHIFT];
+
+	if (!(pde & PAGE_PRESENT))
+		return (0);
+	if (pde & PAGE_LARGE)
+		return ((pde & ~(PAGE_LARGE_SIZE - 1)) | (virt & (PAGE_LARGE_SIZE - 1)));
+
+	u32	pte = ((u32 *)PAGE_ALIGN_DOWN(pde))[(virt >> PAGE_SHIFT) & (PAGE_ENTRIES - 1)];
+
+	if (!(pte & PAGE_PRESENT))
+		return (0);
+	return (PAGE_ALIGN_DOWN(pte) | (virt & (PAGE_SIZE - 1)));
+}
+
+// Mappe [start, end[ sur lui-meme par tranches de 4 Mo, en pages de 4 Mo
+// si le CPU a PSE, sinon via une table de 1024 pages de 4 Ko par tranche.
+// Les mappings du noyau sont globaux: ils survivent aux changements de CR3.
+static void	identity_map(u32 start, u32 end, u32 flags)
+{
+	for (u32 index = start >> PAGE_LARGE_SHIFT; index <= (end - 1) >> PAGE_LARGE_SHIFT; ++index)
+	{
+		u32	base = index << PAGE_LARGE_SHIFT;
+
+		if (page_directory[index] & PAGE_PRESENT)
+			continue ;
+		if (large_pages)
+		{
+			page_directory[index] = base | flags | PAGE_LARGE;
+			invlpg(base);
+			continue ;
+		}
+		for (u32 offset = 0; offset < PAGE_LARGE_SIZE; offset += PAGE_SIZE)
+			if (!paging_map_page(base + offset, base + offset, flags))
+				return ;
+	}
+}
+
+void	paging_identity_map(u32 start, u32 end)
+{
+	identity_map(start, end, PAGE_PRESENT | PAGE_WRITE | global_flag);
+}
+
+// Registres de peripheriques (LAPIC...): chaque acces doit aller au materiel.
+// identity_map saute les tranches deja presentes (framebuffer, table ACPI):
+// on y force PCD/PWT, sur la page de 4 Mo ou sur les pages de 4 Ko visees.
+void	paging_identity_map_mmio(u32 start, u32 end)
+{
+	u32	cache = PAGE_WRITE_THROUGH | PAGE_CACHE_DISABLE;
+	u32	flags = PAGE_PRESENT | PAGE_WRITE | cache | global_flag;
+
+	identity_map(start, end, flags);
+	for (u32 index = start >> PAGE_LARGE_SHIFT; index <= (end - 1) >> PAGE_LARGE_SHIFT; ++index)
+	{
+		u32	base = index << PAGE_LARGE_SHIFT;
+
+		if (page_directory[index] & PAGE_LARGE)
+		{
+			page_directory[index] |= cache;
+			invlpg(base);
+			continue ;
+		}
+		for (u32 page = PAGE_ALIGN_DOWN(start > base ? start : base);
+			page < end && page - base < PAGE_LARGE_SIZE; page += PAGE_SIZE)
+			paging_map_page(page, page, flags);
+	}
+}
+
+static void	page_fault_handler(t_registers *regs)
+{
+	u32	addr = read_cr2();
+
+	// Premier acces a la zone a la demande: on y met un frame tout neuf
+	if (!(regs->err_code & PAGE_FAULT_PRESENT)
+		&& addr >= PAGING_DEMAND_START && addr < PAGING_DEMAND_END)
+	{
+		u32	frame = pmm_alloc_frame();
+
+		if (frame)
+		{
+			ft_memset32((u32 *)frame, 0, PAGE_ENTRIES);
+			if (paging_map_page(PAGE_ALIGN_DOWN(addr), frame, PAGE_WRITE | global_flag))
+			{
+				++demand_faults;
+				return ;
+			}
+			pmm_free_frame(frame);
+		}
+	}
+
+	printk(KERN_ERR "\n[PAGE FAULT] %s 0x%x (%s), error 0x%x at 0x%x\n",
+		regs->err_code & PAGE_FAULT_WRITE ? "write" : "read", addr,
+		regs->err_code & PAGE_FAULT_PRESENT ? "protection" : "not present",
+		regs->err_code, regs->eip);
+	log_panic();
+	asm volatile ("cli; hlt");
+}
+
+void	paging_init(void)
+{
+	u32	features = cpuid_edx();
+	u32	cr0;
+	u32	cr4;
+
+	large_pages = (features & CPUID_EDX_PSE) != 0;
+	global_flag = (features & CPUID_EDX_PGE) ? PAGE_GLOBAL : 0;
+
+	// Toute la RAM vue par le pmm, pour que ses frames restent accessibles
+	identity_end = pmm_memory_end();
+	if (identity_end < (u32)&_kernel_end)
+		identity_end = (u32)&_kernel_end;
+	identity_end = (identity_end | (PAGE_LARGE_SIZE - 1));
+	// Au-dela, la RAM n'est pas identity-mappee: le pmm ne doit plus la donner
+	if (identity_end >= PAGING_DEMAND_START)
+	{
+		identity_end = PAGING_DEMAND_START - 1;
+		pmm_reserve_range(identity_end + 1, 0xFFFFFFFF);
+	}
+
+	ft_memset32(page_directory, 0, PAGE_ENTRIES);
+	paging_identity_map(0, identity_end);
+
+	isr_register_handler(EXCEPTION_PAGE_FAULT, page_fault_handler);
+
+	__asm__ volatile ("mov %%cr4, %0" : "=r"(cr4));
+	if (large_pages)
+		cr4 |= CR4_PSE;
+	if (global_flag)
+		cr4 |= CR4_PGE;
+	__asm__ volatile ("mov %0, %%cr4" : : "r"(cr4));
+	__asm__ volatile ("mov %0, %%cr3" : : "r"(page_directory) : "memory");
+	__asm__ volatile ("mov %%cr0, %0" : "=r"(cr0));
+	cr0 |= CR0_PG | CR0_WP;
+	__asm__ volatile ("mov %0, %%cr0" : : "r"(cr0) : "memory");
+}
+
+void	print_paging(void)
+{
+	printk("Identity map: 0x0 - 0x%x, %s pages%s\n", identity_end,
+		large_pages ? "4 MB" : "4 KB", global_flag ? ", global" : "");
+	printk("Demand-zero:  0x%x - 0x%x, %u pages faulted in\n",
+		PAGING_DEMAND_START, PAGING_DEMAND_END - 1, demand_faults);
+	printk("Page tables:  %u\n", page_tables);
+}
@@ -0,0 +1,83 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pic.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/24 14:22:03 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/24 16:03:12 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/pic.h"
+#include "../includes/io.h"
+
+// Ecriture sur un port inutilise pour laisser le temps au vieux 8259 de suivre
+static inline void	io_wait(void)
+{
+	outb(0x80, 0);
+}
+
+void	pic_remap(u8 master_offset, u8 slave_offset)
+{
+	outb(PIC1_COMMAND, ICW1_INIT | ICW1_ICW4);
+	io_wait();
+	outb(PIC2_COMMAND, ICW1_INIT | ICW1_ICW4);
+	io_wait();
+
+	outb(PIC1_DATA, master_offset);
+	io_wait();
+	outb(PIC2_DATA, slave_offset);
+	io_wait();
+
+	// Le maitre a l'esclave sur IRQ2, l'esclave a l'identite 2
+	outb(PIC1_DATA, 1 << 2);
+	io_wait();
+	outb(PIC2_DATA, 2);
+	io_wait();
+
+	outb(PIC1_DATA, ICW4_8086);
+	io_wait();
+	outb(PIC2_DATA, ICW4_8086);
+	io_wait();
+
+	// Tout est masque sauf la cascade, chaque driver demasque son IRQ
+	outb(PIC1_DATA, (u8)~(1 << 2));
+	outb(PIC2_DATA, 0xFF);
+}
+
+void	pic_send_eoi(u8 irq)
+{
+	if (irq >= 8)
+		outb(PIC2_COMMAND, PIC_EOI);
+	outb(PIC1_COMMAND, PIC_EOI);
+}
+
+void	pic_mask_irq(u8 irq)
+{
+	u16	port = (irq < 8) ? PIC1_DATA : PIC2_DATA;
+
+	outb(port, inb(port) | (1 << (irq & 7)));
+}
+
+void	pic_unmask_irq(u8 irq)
+{
+	u16	port = (irq < 8) ? PIC1_DATA : PIC2_DATA;
+
+	outb(port, inb(port) & ~(1 << (irq & 7)));
+}
+
+u16	pic_get_isr(void)
+{
+	outb(PIC1_COMMAND, PIC_READ_ISR);
+	outb(PIC2_COMMAND, PIC_READ_ISR);
+	return ((inb(PIC2_COMMAND) << 8) | inb(PIC1_COMMAND));
+}
+
+u16	pic_get_irr(void)
+{
+	outb(PIC1_COMMAND, PIC_READ_IRR);
+	outb(PIC2_COMMAND, PIC_READ_IRR);
+	return ((inb(PIC2_COMMAND) << 8) | inb(PIC1_COMMAND));
+}
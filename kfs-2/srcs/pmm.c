@@ -0,0 +1,250 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   pmm.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/27 11:21:37 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/27 17:06:13 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/pmm.h"
+#include "../includes/kernel.h"
+#include "../includes/io.h"
+
+extern u32	_kernel_end;
+
+// Bitmap hierarchique, bit a 1 = libre. level0 a un bit par frame, chaque
+// niveau au-dessus a un bit par mot du niveau en dessous qui a encore un bit
+// a 1. 32^4 = 1M frames: allouer = quatre bsf, quelle que soit la RAM.
+static u32	level0[PMM_MAX_FRAMES / 32];
+static u32	level1[PMM_MAX_FRAMES / 32 / 32];
+static u32	level2[PMM_MAX_FRAMES / 32 / 32 / 32];
+static u32	level3 = 0;
+
+static u32	free_count = 0;
+static u32	total_count = 0;
+static u32	memory_end = 0;
+
+static bool	frame_is_free(u32 frame)
+{
+	return ((level0[frame >> 5] >> (frame & 31)) & 1);
+}
+
+static void	frame_set_free(u32 frame)
+{
+	u32	word = frame >> 5;
+
+	level0[word] |= 1u << (frame & 31);
+	level1[word >> 5] |= 1u << (word & 31);
+	level2[word >> 10] |= 1u << ((word >> 5) & 31);
+	level3 |= 1u << (word >> 10);
+	++free_count;
+}
+
+static void	frame_set_used(u32 frame)
+{
+	u32	word = frame >> 5;
+
+	level0[word] &= ~(1u << (frame & 31));
+	if (level0[word] == 0)
+	{
+		level1[word >> 5] &= ~(1u << (word & 31));
+		if (level1[word >> 5] == 0)
+		{
+			level2[word >> 10] &= ~(1u << ((word >> 5) & 31));
+			if (level2[word >> 10] == 0)
+				level3 &= ~(1u << (word >> 10));
+		}
+	}
+	--free_count;
+}
+
+static void	pmm_free_range(u64 start, u64 end)
+{
+	if (end > (u64)PMM_MAX_FRAMES << PAGE_SHIFT)
+		end = (u64)PMM_MAX_FRAMES << PAGE_SHIFT;
+
+	// Seuls les frames entierement dans la zone sont utilisables
+	u32	first = (start + PAGE_SIZE - 1) >> PAGE_SHIFT;
+	u32	last = end >> PAGE_SHIFT;
+
+	if (last > first && (last << PAGE_SHIFT) - 1 > memory_end)
+		memory_end = (last << PAGE_SHIFT) - 1;
+	u32	frame = first;
+
+	while (frame < last)
+	{
+		u32	word = frame >> 5;
+
+		// Mot entier dans la zone et encore vide: 32 frames d'un coup
+		if (!(frame & 31) && frame + 32 <= last && level0[word] == 0)
+		{
+			level0[word] = 0xFFFFFFFF;
+			level1[word >> 5] |= 1u << (word & 31);
+			level2[word >> 10] |= 1u << ((word >> 5) & 31);
+			level3 |= 1u << (word >> 10);
+			free_count += 32;
+			total_count += 32;
+			frame += 32;
+			continue ;
+		}
+		if (!frame_is_free(frame))
+		{
+			frame_set_free(frame);
+			++total_count;
+		}
+		++frame;
+	}
+}
+
+void	pmm_reserve_range(u32 start, u32 end)
+{
+	u32	first = start >> PAGE_SHIFT;
+	// En 64 bits: end peut aller jusqu'a 0xFFFFFFFF sans reboucler
+	u32	last = ((u64)end + PAGE_SIZE - 1) >> PAGE_SHIFT;
+
+	for (u32 frame = first; frame < last && frame < PMM_MAX_FRAMES; ++frame)
+		if (frame_is_free(frame))
+			frame_set_used(frame);
+}
+
+// Premier Mo: IVT/BDA, GDT a 0x800, EBDA, VGA a 0xA0000 et ROM BIOS.
+// Le frame 0 n'est jamais rendu, 0 sert donc de valeur d'echec.
+static void	pmm_reserve_boot(u32 info_start, u32 info_end)
+{
+	pmm_reserve_range(0, PMM_LOW_MEMORY_END);
+	pmm_reserve_range(PMM_LOW_MEMORY_END, (u32)&_kernel_end);
+	pmm_reserve_range(info_start, info_end);
+}
+
+void	pmm_init(t_multiboot_info *mbi)
+{
+	if (mbi->flags & MULTIBOOT_INFO_MEM_MAP)
+	{
+		u32	addr = mbi->mmap_addr;
+
+		while (addr < mbi->mmap_addr + mbi->mmap_length)
+		{
+			t_multiboot_mmap_entry	*entry = (t_multiboot_mmap_entry *)addr;
+
+			if (entry->type == MULTIBOOT_MEMORY_AVAILABLE)
+				pmm_free_range(entry->addr, entry->addr + entry->len);
+			addr += entry->size + sizeof(entry->size);
+		}
+	}
+	else if (mbi->flags & MULTIBOOT_INFO_MEMORY)
+		pmm_free_range(PMM_LOW_MEMORY_END, PMM_LOW_MEMORY_END + (u64)mbi->mem_upper * 1024);
+
+	pmm_reserve_boot((u32)mbi, (u32)mbi + sizeof(*mbi));
+	if (mbi->flags & MULTIBOOT_INFO_MEM_MAP)
+		pmm_reserve_range(mbi->mmap_addr, mbi->mmap_addr + mbi->mmap_length);
+}
+
+// Avec multiboot 2 la carte est un tag, dans le bloc d'infos lui-meme
+void	pmm_init_multiboot2(const t_multiboot2_info *info)
+{
+	const t_multiboot2_tag_mmap	*mmap;
+
+	mmap = (const t_multiboot2_tag_mmap *)multiboot2_find_tag(info, MULTIBOOT2_TAG_MMAP);
+	// Une entry_size trop petite bouclerait sur la meme entree
+	if (mmap && mmap->entry_size >= sizeof(t_multiboot2_mmap_entry))
+	{
+		const u8	*addr = (const u8 *)mmap + sizeof(*mmap);
+		const u8	*end = (const u8 *)mmap + mmap->size;
+
+		for (; addr < end; addr += mmap->entry_size)
+		{
+			const t_multiboot2_mmap_entry	*entry = (const t_multiboot2_mmap_entry *)addr;
+
+			if (entry->type == MULTIBOOT_MEMORY_AVAILABLE)
+				pmm_free_range(entry->addr, entry->addr + entry->len);
+		}
+	}
+	pmm_reserve_boot((u32)info, (u32)info + info->total_size);
+}
+
+u32	pmm_alloc_frame(void)
+{
+	if (!level3)
+		return (0);
+
+	u32	word2 = __builtin_ctz(level3);
+	u32	word1 = (word2 << 5) | __builtin_ctz(level2[word2]);
+	u32	word0 = (word1 << 5) | __builtin_ctz(level1[word1]);
+	u32	frame = (word0 << 5) | __builtin_ctz(level0[word0]);
+
+	frame_set_used(frame);
+	return (frame << PAGE_SHIFT);
+}
+
+void	pmm_free_frame(u32 addr)
+{
+	u32	frame = addr >> PAGE_SHIFT;
+
+	if (frame == 0 || frame >= PMM_MAX_FRAMES || frame_is_free(frame))
+		return ;
+	frame_set_free(frame);
+}
+
+u32	pmm_free_frames(void)
+{
+	return (free_count);
+}
+
+u32	pmm_total_frames(void)
+{
+	return (total_count);
+}
+
+// Dernier octet de RAM utilisable (inclus, pour tenir sur 32 bits a 4 Go)
+u32	pmm_memory_end(void)
+{
+	return (memory_end);
+}
+
+# define PMM_BENCH_FRAMES	256
+
+void	print_memory(void)
+{
+	static u32	frames[PMM_BENCH_FRAMES];
+	u32			alloc_total = 0;
+	u32			alloc_max = 0;
+	u32			free_total = 0;
+	u32			free_max = 0;
+	u32			count = 0;
+
+	printk("Frames: %u total, %u free, %u used (%u KB free)\n", total_count,
+		free_count, total_count - free_count, free_count * (PAGE_SIZE / 1024));
+
+	while (count < PMM_BENCH_FRAMES)
+	{
+		u64	start = rdtsc();
+		u32	frame = pmm_alloc_frame();
+		u32	cycles = (u32)(rdtsc() - start);
+
+		if (!frame)
+			break ;
+		frames[count++] = frame;
+		alloc_total += cycles;
+		if (cycles > alloc_max)
+			alloc_max = cycles;
+	}
+	for (u32 index = 0; index < count; ++index)
+	{
+		u64	start = rdtsc();
+		pmm_free_frame(frames[index]);
+		u32	cycles = (u32)(rdtsc() - start);
+
+		free_total += cycles;
+		if (cycles > free_max)
+			free_max = cycles;
+	}
+	if (count)
+	{
+		printk("alloc: avg %u cycles, max %u (%u frames)\n", alloc_total / count, alloc_max, count);
+		printk("free:  avg %u cycles, max %u\n", free_total / count, free_max);
+	}
+}
@@ -1,121 +1,351 @@
 #include "../includes/kernel.h"
 #include "../includes/vargs.h"
+#include "../includes/log.h"
+#include "../includes/io.h"
+#include "../includes/div64.h"
 
-int	putnbr_base(unsigned long num, int base, int uppercase)
+// Le message est formate ici puis part en un seul enregistrement du journal;
+// au-dela de LOG_TEXT_MAX il est coupe en plusieurs
+typedef struct s_printk_buffer
 {
-	char	buffer[32];
-	int		value = 0;
-	char	*digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+	char	data[LOG_TEXT_MAX];
+	size_t	len;
+	int		total;
+	u8		level;
+}	t_printk_buffer;
 
-	if (num == 0)
+// %[-][0][largeur|*][l|ll]conversion
+typedef struct s_format
+{
+	bool	left;
+	char	pad;
+	size_t	width;
+	int		longs;		// nombre de 'l': 2 pour les entiers 64 bits
+}	t_format;
+
+// Paires de chiffres: deux caracteres par pas, sans division
+static const char	hex_pairs[513] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static const char	dec_pairs[201] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static void	buffer_flush(t_printk_buffer *buf)
+{
+	if (buf->len)
+		log_store(buf->level, buf->data, buf->len);
+	buf->len = 0;
+}
+
+static void	buffer_write(t_printk_buffer *buf, const char *data, size_t size)
+{
+	buf->total += size;
+	while (size)
 	{
-		terminal_putchar('0');
-		return (1);
+		size_t	chunk = LOG_TEXT_MAX - buf->len;
+
+		if (chunk > size)
+			chunk = size;
+		ft_memcpy(buf->data + buf->len, data, chunk);
+		buf->len += chunk;
+		data += chunk;
+		size -= chunk;
+		if (buf->len == LOG_TEXT_MAX)
+			buffer_flush(buf);
 	}
-	while (num > 0)
+}
+
+static void	buffer_fill(t_printk_buffer *buf, char c, size_t count)
+{
+	buf->total += count;
+	while (count)
+	{
+		size_t	chunk = LOG_TEXT_MAX - buf->len;
+
+		if (chunk > count)
+			chunk = count;
+		ft_memset(buf->data + buf->len, c, chunk);
+		buf->len += chunk;
+		count -= chunk;
+		if (buf->len == LOG_TEXT_MAX)
+			buffer_flush(buf);
+	}
+}
+
+// Le prefixe (signe, 0x) passe avant les zeros de remplissage
+static void	put_field(t_printk_buffer *buf, const t_format *format,
+	const char *prefix, const char *data, size_t len)
+{
+	size_t	prefix_len = ft_strlen(prefix);
+	size_t	fill = 0;
+
+	if (format->width > prefix_len + len)
+		fill = format->width - prefix_len - len;
+	if (!format->left && format->pad == ' ')
+		buffer_fill(buf, ' ', fill);
+	buffer_write(buf, prefix, prefix_len);
+	if (!format->left && format->pad == '0')
+		buffer_fill(buf, '0', fill);
+	buffer_write(buf, data, len);
+	if (format->left)
+		buffer_fill(buf, ' ', fill);
+}
+
+// Les putnbr_* ecrivent de droite a gauche en finissant a end et renvoient
+// le premier chiffre: pas de retournement.
+// Version generique (un div par chiffre), gardee comme reference pour les mesures.
+char	*putnbr_base(char *end, unsigned long num, int base, int uppercase)
+{
+	const char	*digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+
+	do
 	{
-		buffer[value++] = digits[num % base];
+		*--end = digits[num % base];
 		num = num / base;
+	} while (num > 0);
+	return (end);
+}
+
+// num / 100 par multiplication: 0x51EB851F = 2^37 / 100 arrondi au-dessus,
+// exact pour tout u32
+static inline u32	div100(u32 num)
+{
+	return ((u32)(((u64)num * 0x51EB851F) >> 37));
+}
+
+char	*putnbr_dec(char *end, u32 num)
+{
+	while (num >= 100)
+	{
+		u32	quotient = div100(num);
+		u32	pair = (num - quotient * 100) * 2;
+
+		*--end = dec_pairs[pair + 1];
+		*--end = dec_pairs[pair];
+		num = quotient;
 	}
-	for (int index = value - 1; index >= 0; --index)
-		terminal_putchar(buffer[index]);
+	if (num >= 10)
+	{
+		*--end = dec_pairs[num * 2 + 1];
+		*--end = dec_pairs[num * 2];
+	}
+	else
+		*--end = '0' + num;
+	return (end);
+}
 
-	return (value);
+// Un octet par pas; seul le dernier peut laisser un '0' de tete
+char	*putnbr_hex(char *end, u32 num, int uppercase)
+{
+	char	*stop = end;
+
+	do
+	{
+		*--end = hex_pairs[(num & 0xFF) * 2 + 1];
+		*--end = hex_pairs[(num & 0xFF) * 2];
+		num >>= 8;
+	} while (num);
+	if (*end == '0')
+		++end;
+	if (uppercase)
+		for (char *digit = end; digit < stop; ++digit)
+			if (*digit >= 'a')
+				*digit -= 'a' - 'A';
+	return (end);
 }
 
-int	check_format(va_list args, char c)
+// Par blocs de 9 chiffres: la division 64 bits se fait en deux divl de
+// 32 bits (div64_32), sans __udivdi3
+char	*putnbr_dec64(char *end, u64 num)
 {
-	int	value = 0;
+	while (num >> 32)
+	{
+		u32		high = num >> 32;
+		u32		block;
+		u32		low = div64_32(((u64)(high % 1000000000) << 32) | (u32)num, 1000000000, &block);
+		char	*stop = end - 9;
+
+		end = putnbr_dec(end, block);
+		while (end > stop)
+			*--end = '0';
+		num = ((u64)(high / 1000000000) << 32) | low;
+	}
+	return (putnbr_dec(end, (u32)num));
+}
+
+char	*putnbr_hex64(char *end, u64 num, int uppercase)
+{
+	char	*stop = end - 8;
+
+	if ((num >> 32) == 0)
+		return (putnbr_hex(end, (u32)num, uppercase));
+	end = putnbr_hex(end, (u32)num, uppercase);
+	while (end > stop)
+		*--end = '0';
+	return (putnbr_hex(end, (u32)(num >> 32), uppercase));
+}
+
+// Renvoie false pour une conversion inconnue, recopiee telle quelle
+static bool	check_format(t_printk_buffer *buf, va_list *args, const t_format *format, char c)
+{
+	char		digits[32];
+	char		*end = digits + sizeof(digits);
+	char		*start;
+	const char	*prefix = "";
 
 	switch (c)
 	{
 		case 'd':
 		case 'i':
 		{
-			int	num = va_arg(args, int);
+			i64	num = format->longs == 2 ? va_arg(*args, i64) : va_arg(*args, int);
+			u64	magnitude = num;
+
 			if (num < 0)
 			{
-				terminal_putchar('-');
-				++value;
-				num = -num;
+				prefix = "-";
+				magnitude = -magnitude;
 			}
-				value += putnbr_base(num, 10, 0);
-				break ;
+			start = putnbr_dec64(end, magnitude);
+			break ;
 		}
-		
+
 		case 'u':
-			value += putnbr_base(va_arg(args, unsigned int), 10, 0);
-			break ;
-		
-		case 'x':
-			value += putnbr_base(va_arg(args, unsigned int), 16, 0);
+			if (format->longs == 2)
+				start = putnbr_dec64(end, va_arg(*args, u64));
+			else
+				start = putnbr_dec(end, va_arg(*args, unsigned int));
 			break ;
 
+		case 'x':
 		case 'X':
-			value += putnbr_base(va_arg(args, unsigned int), 16, 1);
+			if (format->longs == 2)
+				start = putnbr_hex64(end, va_arg(*args, u64), c == 'X');
+			else
+				start = putnbr_hex(end, va_arg(*args, unsigned int), c == 'X');
 			break ;
 
 		case 'p':
-		{
-			terminal_write_string("0x");
-			value = 2 + putnbr_base((unsigned long)va_arg(args, void*), 16, 0);
+			prefix = "0x";
+			start = putnbr_hex(end, (u32)va_arg(*args, void *), 0);
 			break ;
-		}
 
 		case 's':
 		{
-			char *str = va_arg(args, char *);
+			char *str = va_arg(*args, char *);
 			if (!str)
 				str = ("null");
-			terminal_write_string(str);
-			value = ft_strlen(str);
-			break ;
+			put_field(buf, format, "", str, ft_strlen(str));
+			return (true);
 		}
 
 		case 'c':
-			terminal_putchar((char)va_arg(args, int));
-			value = 1;
-			break ;
-
-		case '%':
-			terminal_putchar('%');
-			value = 1;
-			break ;
+			digits[0] = (char)va_arg(*args, int);
+			put_field(buf, format, "", digits, 1);
+			return (true);
 
 		default:
-			terminal_putchar('%');
-			terminal_putchar(c);
-			value = 2;
-			break ;
+			return (false);
 	}
-	return (value);
+	put_field(buf, format, prefix, start, end - start);
+	return (true);
+}
+
+// Lit flags, largeur et taille apres le '%', str pointe ensuite sur la conversion
+static const char	*parse_format(const char *str, va_list *args, t_format *format)
+{
+	format->left = false;
+	format->pad = ' ';
+	format->width = 0;
+	while (*str == '-' || *str == '0')
+	{
+		if (*str == '-')
+			format->left = true;
+		else
+			format->pad = '0';
+		++str;
+	}
+	if (*str == '*')
+	{
+		int	width = va_arg(*args, int);
+
+		if (width < 0)
+		{
+			format->left = true;
+			width = -width;
+		}
+		format->width = width;
+		++str;
+	}
+	while (*str >= '0' && *str <= '9')
+		format->width = format->width * 10 + *str++ - '0';
+	// long fait 32 bits ici: seul ll change la taille lue
+	format->longs = 0;
+	while (*str == 'l' && format->longs < 2)
+	{
+		++format->longs;
+		++str;
+	}
+	if (format->left)
+		format->pad = ' ';
+	return (str);
 }
 
 int	printk(const char *str, ...)
 {
-	va_list	args;
-	int		value = 0;
-	int		index = 0;
+	va_list			args;
+	t_printk_buffer	buf;
+	t_format		format;
 
-	va_start(args, str);
 	if (!str)
 		return (-1);
+	va_start(args, str);
+	buf.len = 0;
+	buf.total = 0;
+	buf.level = LOG_DEFAULT;
+	if (str[0] == KERN_SOH[0] && str[1] >= '0' && str[1] <= '7')
+	{
+		buf.level = str[1] - '0';
+		str += 2;
+	}
 
-	while (str[index])
+	while (*str)
 	{
-		if (str[index] == '%' && str[index + 1] != '\0')
-		{
-			++index;
-			value += check_format(args, str[index]);
-		}
-		else
+		const char	*next = ft_strchrnul(str, '%');
+
+		buffer_write(&buf, str, next - str);
+		str = next;
+		if (*str != '%')
+			break ;
+		next = parse_format(str + 1, &args, &format);
+		// Format coupe par la fin de la chaine: recopie tel quel
+		if (*next == '\0')
 		{
-			terminal_putchar(str[index]);
-			++value;
+			buffer_write(&buf, str, next - str);
+			break ;
 		}
-		index++;
+		if (*next == '%')
+			buffer_write(&buf, "%", 1);
+		else if (!check_format(&buf, &args, &format, *next))
+			buffer_write(&buf, str, next + 1 - str);
+		str = next + 1;
 	}
 	va_end(args);
+	buffer_flush(&buf);
+	// Hors IRQ, une longue sortie est rendue avant de remplir l'anneau
+	if (log_pending() >= LOG_SLOTS / 2 && irq_enabled())
+		log_drain();
 
-	return (value);
+	return (buf.total);
 }
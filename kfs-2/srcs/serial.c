@@ -0,0 +1,105 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   serial.c                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/26 10:06:02 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/26 15:20:44 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/serial.h"
+#include "../includes/console.h"
+#include "../includes/idt.h"
+#include "../includes/io.h"
+
+// printk remplit tx_buffer, et l'UART est alimente par paquets de 16 octets
+// (la taille de sa FIFO) a chaque interruption "THR vide" de l'IRQ4
+static char		tx_buffer[SERIAL_TX_SIZE];
+static size_t	tx_head = 0;
+static size_t	tx_tail = 0;
+static u8		ier = 0;
+
+static t_console	serial_console = {"serial", serial_write, false};
+
+// A appeler interruptions coupees
+static void	serial_fill_fifo(void)
+{
+	if (!(inb(COM1_PORT + SERIAL_LSR) & SERIAL_LSR_THRE))
+		return ;
+
+	for (int count = 0; count < SERIAL_FIFO_SIZE && tx_tail != tx_head; ++count)
+	{
+		outb(COM1_PORT + SERIAL_DATA, tx_buffer[tx_tail]);
+		tx_tail = (tx_tail + 1) & SERIAL_TX_MASK;
+	}
+
+	u8	wanted = (tx_tail != tx_head) ? SERIAL_IER_THRE : 0;
+	if (wanted != ier)
+	{
+		ier = wanted;
+		outb(COM1_PORT + SERIAL_IER, ier);
+	}
+}
+
+static void	serial_irq(t_registers *regs)
+{
+	(void)regs;
+	inb(COM1_PORT + SERIAL_IIR);
+	serial_fill_fifo();
+}
+
+static void	serial_push(char c)
+{
+	// Tampon plein: on attend que la FIFO se vide, 16 octets a la fois
+	while (((tx_head + 1) & SERIAL_TX_MASK) == tx_tail)
+		serial_fill_fifo();
+	tx_buffer[tx_head] = c;
+	tx_head = (tx_head + 1) & SERIAL_TX_MASK;
+}
+
+void	serial_write(const char *data, size_t size)
+{
+	u32	flags = irq_save();
+
+	for (size_t index = 0; index < size; ++index)
+	{
+		if (data[index] == '\n')
+			serial_push('\r');
+		serial_push(data[index]);
+	}
+	serial_fill_fifo();
+	irq_restore(flags);
+}
+
+// Vide tout le tampon en attente active, avant un arret de la machine
+void	serial_flush(void)
+{
+	u32	flags = irq_save();
+
+	while (tx_tail != tx_head)
+		serial_fill_fifo();
+	irq_restore(flags);
+}
+
+bool	serial_init(void)
+{
+	// Pas d'UART si le registre scratch ne garde pas ce qu'on y ecrit
+	outb(COM1_PORT + SERIAL_SCRATCH, 0xA5);
+	if (inb(COM1_PORT + SERIAL_SCRATCH) != 0xA5)
+		return (false);
+
+	outb(COM1_PORT + SERIAL_IER, 0);
+	outb(COM1_PORT + SERIAL_LCR, SERIAL_LCR_DLAB);
+	outb(COM1_PORT + SERIAL_DIVISOR_LOW, SERIAL_BAUD_DIVISOR & 0xFF);
+	outb(COM1_PORT + SERIAL_DIVISOR_HIGH, (SERIAL_BAUD_DIVISOR >> 8) & 0xFF);
+	outb(COM1_PORT + SERIAL_LCR, SERIAL_LCR_8N1);
+	outb(COM1_PORT + SERIAL_FCR, SERIAL_FCR_ENABLE);
+	outb(COM1_PORT + SERIAL_MCR, SERIAL_MCR_IRQ);
+
+	irq_register_handler(IRQ_COM1, serial_irq);
+	console_register(&serial_console);
+	return (true);
+}
@@ -11,8 +11,17 @@
 /* ************************************************************************** */
 
 #include "../includes/kernel.h"
+#include "../includes/shell.h"
 #include "../includes/io.h"
 #include "../includes/gdt.h"
+#include "../includes/timer.h"
+#include "../includes/div64.h"
+#include "../includes/serial.h"
+#include "../includes/pmm.h"
+#include "../includes/paging.h"
+#include "../includes/kmalloc.h"
+#include "../includes/trace.h"
+#include "../includes/log.h"
 
 int		ft_strncmp(const char *s1, const char *s2, size_t len)
 {
@@ -27,61 +36,241 @@ int		ft_strncmp(const char *s1, const char *s2, size_t len)
 
 size_t	get_cmd(const char *cmd)
 {
-	size_t	index = 0;
+	return (ft_strchrnul(cmd, ' ') - cmd);
+}
 
-	while (cmd[index] && cmd[index] != ' ')
-		index++;
-	return (index);
+static const char	*get_args(const char *cmd, size_t len)
+{
+	cmd += len;
+	while (*cmd == ' ')
+		cmd++;
+	return (cmd);
 }
 
-void	execute_command(const char *cmd)
+static u32	ft_atou(const char *str)
 {
-	size_t	len;
+	u32	value = 0;
 
-	if (!cmd || !*cmd)
-		return ;
-		
-	len = get_cmd(cmd);
+	while (*str >= '0' && *str <= '9')
+		value = value * 10 + (*str++ - '0');
+	return (value);
+}
 
-	if (len == 4 && ft_strncmp(cmd,	"help", 4) == 0)
-	{
-		printk("Commands:\n");
-		printk("help         - show this message\n");
-		printk("clear        - clear screen\n");
-		printk("reboot       - reboot machine\n");
-		printk("halt         - stop cpu\n");
-		printk("exit         - exit kernel\n");
-		printk("stack        - print stack\n");
-		printk("gdt          - print gdt\n");
-		printk("Hello there  - print easter egg\n");
-	}
-	
-	else if (len == 5 && ft_strncmp(cmd, "clear", 5) == 0)
-		terminal_clear_screen();
+static void	print_uptime(void)
+{
+	u32	ms;
+	u32	sec = div64_32(timer_now_us(), 1000000, &ms);
+
+	ms /= 1000;
+	printk("up %u:", sec / 3600);
+	if (sec / 60 % 60 < 10)
+		printk("0");
+	printk("%u:", sec / 60 % 60);
+	if (sec % 60 < 10)
+		printk("0");
+	printk("%u.", sec % 60);
+	if (ms < 100)
+		printk("0");
+	if (ms < 10)
+		printk("0");
+	printk("%u\n", ms);
+}
 
-	else if (len == 6 && ft_strncmp(cmd, "reboot", 6) == 0)
-		outb(0x64, 0xFE);
+// Lance une commande et affiche sa duree, en temps PIT et en cycles TSC
+static void	time_command(const char *cmd)
+{
+	u64	start_us = timer_now_us();
+	u64	start_tsc = rdtsc();
 
-	else if (len == 4 && ft_strncmp(cmd, "halt", 4) == 0)
-		asm volatile ("cli; hlt");
-	
-	else if (len == 4 && ft_strncmp(cmd, "exit", 4) == 0)
-		outw(0x604, 0x2000);
+	execute_command(cmd);
+
+	u64	cycles = rdtsc() - start_tsc;
+	u64	elapsed_us = timer_now_us() - start_us;
+
+	printk("real %llu us, %llu kcycles\n", elapsed_us, div64(cycles, 1000));
+}
+
+static void	command_help(const char *args);
+
+static void	command_clear(const char *args)
+{
+	(void)args;
+	terminal_clear_screen();
+}
+
+static void	command_reboot(const char *args)
+{
+	(void)args;
+	outb(0x64, 0xFE);
+}
+
+static void	command_halt(const char *args)
+{
+	(void)args;
+	terminal_flush();
+	serial_flush();
+	asm volatile ("cli; hlt");
+}
+
+static void	command_exit(const char *args)
+{
+	(void)args;
+	// printk ne fait que journaliser: tout rendre avant de vider l'UART
+	log_drain();
+	serial_flush();
+	outw(0x604, 0x2000);
+}
+
+static void	command_gdt(const char *args)
+{
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	print_gdt();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+static void	command_stack(const char *args)
+{
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	print_stack();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+static void	command_mem(const char *args)
+{
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	print_memory();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+static void	command_paging(const char *args)
+{
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	print_paging();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+static void	command_heap(const char *args)
+{
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	print_heap();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+static void	command_uptime(const char *args)
+{
+	(void)args;
+	print_uptime();
+}
+
+static void	command_sleep(const char *args)
+{
+	timer_sleep_ms(ft_atou(args));
+}
+
+static void	command_hello(const char *args)
+{
+	if (ft_strncmp(args, "there", 6) == 0)
+		printk("General Kenobi\n");
+}
+
+SHELL_COMMAND("help", "help", "show this message", command_help);
+SHELL_COMMAND("clear", "clear", "clear screen", command_clear);
+SHELL_COMMAND("reboot", "reboot", "reboot machine", command_reboot);
+SHELL_COMMAND("halt", "halt", "stop cpu", command_halt);
+SHELL_COMMAND("exit", "exit", "exit kernel", command_exit);
+SHELL_COMMAND("stack", "stack", "print stack", command_stack);
+SHELL_COMMAND("gdt", "gdt", "print gdt", command_gdt);
+SHELL_COMMAND("mem", "mem", "physical frames and alloc cost", command_mem);
+SHELL_COMMAND("paging", "paging", "page tables and demand faults", command_paging);
+SHELL_COMMAND("heap", "heap", "kmalloc caches and latency", command_heap);
+SHELL_COMMAND("uptime", "uptime", "time since boot", command_uptime);
+SHELL_COMMAND("sleep", "sleep <ms>", "sleep without spinning", command_sleep);
+SHELL_COMMAND("time", "time <cmd>", "measure a command", time_command);
+SHELL_COMMAND("Hello", "Hello there", "print easter egg", command_hello);
+
+extern t_command	__commands_start[];
+extern t_command	__commands_end[];
+
+static size_t	command_count = 0;
+
+// Ordre de strcmp entre le nom et le mot tape (cmd, len), sans copier le mot
+static int	command_compare(const char *name, const char *cmd, size_t len)
+{
+	int	diff = ft_strncmp(name, cmd, len);
+
+	if (diff)
+		return (diff);
+	return ((unsigned char)name[len]);
+}
 
-	else if (len == 3 && ft_strncmp(cmd, "gdt", 3) == 0)
+static t_command	*find_command(const char *cmd, size_t len)
+{
+	size_t	low = 0;
+	size_t	high = command_count;
+
+	while (low < high)
 	{
-		terminal_set_color(VGA_COLOR_WHITE);
-		print_gdt();
-		terminal_set_color(VGA_COLOR_LIGHT_RED2);
+		size_t	middle = (low + high) / 2;
+		int		diff = command_compare(__commands_start[middle].name, cmd, len);
+
+		if (diff == 0)
+			return (&__commands_start[middle]);
+		if (diff < 0)
+			low = middle + 1;
+		else
+			high = middle;
 	}
+	return (NULL);
+}
 
-	else if (len == 5 && ft_strncmp(cmd, "stack", 5) == 0)
+// Tri par insertion une fois au boot, l'ordre de l'editeur de liens est quelconque
+void	shell_init(void)
+{
+	command_count = __commands_end - __commands_start;
+	for (size_t index = 1; index < command_count; ++index)
 	{
-		terminal_set_color(VGA_COLOR_WHITE);
-		print_stack();
-		terminal_set_color(VGA_COLOR_LIGHT_RED2);
+		t_command	entry = __commands_start[index];
+		size_t		pos = index;
+
+		while (pos > 0 && command_compare(__commands_start[pos - 1].name,
+				entry.name, ft_strlen(entry.name)) > 0)
+		{
+			__commands_start[pos] = __commands_start[pos - 1];
+			--pos;
+		}
+		__commands_start[pos] = entry;
 	}
+}
 
-	else if (ft_strncmp(cmd, "Hello there", 11) == 0)
-		printk("General Kenobi\n");
+static void	command_help(const char *args)
+{
+	(void)args;
+	printk("Commands:\n");
+	for (size_t index = 0; index < command_count; ++index)
+	{
+		t_command	*command = &__commands_start[index];
+
+		printk("%-*s- %s\n", SHELL_USAGE_WIDTH, command->usage, command->help);
+	}
+}
+
+void	execute_command(const char *cmd)
+{
+	t_command	*command;
+	size_t		len;
+
+	if (!cmd || !*cmd)
+		return ;
+
+	len = get_cmd(cmd);
+	command = find_command(cmd, len);
+	TRACE(TRACE_COMMAND_BEGIN, len, command);
+	if (command)
+		command->handler(get_args(cmd, len));
+	TRACE(TRACE_COMMAND_END, len, command);
 }
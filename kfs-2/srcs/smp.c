@@ -0,0 +1,226 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   smp.c                                              :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/11 11:02:47 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/13 17:48:30 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/smp.h"
+#include "../includes/kernel.h"
+#include "../includes/log.h"
+#include "../includes/acpi.h"
+#include "../includes/paging.h"
+#include "../includes/idt.h"
+#include "../includes/io.h"
+#include "../includes/timer.h"
+#include "../includes/div64.h"
+#include "../includes/shell.h"
+
+extern u8			smp_trampoline_start[];
+extern u8			smp_trampoline_params[];
+extern u8			smp_trampoline_end[];
+extern u8			stack_top[];
+extern t_gdt_ptr	gdt_ptr;
+extern void			isr_spurious(void);
+
+static t_cpu			cpus[SMP_MAX_CPUS];
+static u32				cpu_count = 1;
+// Le BSP garde la pile de boot.s
+static u8				ap_stacks[SMP_MAX_CPUS - 1][SMP_STACK_SIZE] __attribute__((aligned(16)));
+static volatile u32		*lapic = NULL;
+
+static const char		*cpu_state_names[] = {
+	[CPU_OFFLINE] = "offline",
+	[CPU_STARTING] = "starting",
+	[CPU_ONLINE] = "online",
+	[CPU_FAILED] = "failed",
+};
+
+static inline u32	lapic_read(u32 reg)
+{
+	return (lapic[reg / sizeof(u32)]);
+}
+
+static inline void	lapic_write(u32 reg, u32 value)
+{
+	lapic[reg / sizeof(u32)] = value;
+}
+
+static void	lapic_enable(void)
+{
+	lapic_write(LAPIC_SVR, LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+}
+
+static void	lapic_send_ipi(u32 apic_id, u32 command)
+{
+	lapic_write(LAPIC_ESR, 0);
+	lapic_write(LAPIC_ICR_HIGH, apic_id << 24);
+	lapic_write(LAPIC_ICR_LOW, command);
+	while (lapic_read(LAPIC_ICR_LOW) & LAPIC_ICR_PENDING)
+		__asm__ volatile ("pause");
+}
+
+static void	cpu_setup(u32 index, u32 apic_id, u32 stack)
+{
+	t_cpu	*cpu = &cpus[index];
+
+	cpu->self = cpu;
+	cpu->index = index;
+	cpu->apic_id = apic_id;
+	cpu->stack_top = stack;
+	gdt_set_cpu(index, &cpu->tss, stack, cpu, sizeof(t_cpu));
+}
+
+// Premier code C d'un AP, deja sur sa pile, pagination active
+static void	ap_main(u32 index)
+{
+	idt_load();
+	gdt_load_cpu(index);
+	lapic_enable();
+	this_cpu()->state = CPU_ONLINE;
+	// Pas encore de travail pour les APs: ils dorment, interruptions coupees
+	while (1)
+		__asm__ volatile ("cli; hlt");
+}
+
+// Le LAPIC peut etre deplace par une entree de type 5 (adresse 64 bits)
+static void	lapic_map(const t_acpi_madt *madt)
+{
+	const u8	*entry = (const u8 *)(madt + 1);
+	const u8	*end = (const u8 *)madt + madt->header.length;
+	u32			base = madt->lapic_address;
+
+	for (; entry + sizeof(t_madt_entry) <= end && entry[1] >= sizeof(t_madt_entry); entry += entry[1])
+	{
+		const t_madt_lapic_override	*override = (const t_madt_lapic_override *)entry;
+
+		if (override->type == MADT_LAPIC_OVERRIDE && (override->address >> 32) == 0)
+			base = (u32)override->address;
+	}
+	if (!base)
+		base = LAPIC_DEFAULT_BASE;
+	paging_identity_map_mmio(base, base + PAGE_SIZE);
+	lapic = (volatile u32 *)base;
+}
+
+static void	madt_add_cpus(const t_acpi_madt *madt)
+{
+	const u8	*entry = (const u8 *)(madt + 1);
+	const u8	*end = (const u8 *)madt + madt->header.length;
+
+	for (; entry + sizeof(t_madt_entry) <= end && entry[1] >= sizeof(t_madt_entry); entry += entry[1])
+	{
+		const t_madt_local_apic	*local = (const t_madt_local_apic *)entry;
+
+		if (local->type != MADT_LOCAL_APIC || !(local->flags & MADT_LAPIC_ENABLED)
+			|| local->apic_id == cpus[0].apic_id)
+			continue ;
+		if (cpu_count == SMP_MAX_CPUS)
+		{
+			printk(KERN_WARNING "smp: more than %u CPUs, APIC %u ignored\n", SMP_MAX_CPUS, local->apic_id);
+			continue ;
+		}
+		cpu_setup(cpu_count, local->apic_id, (u32)ap_stacks[cpu_count - 1] + SMP_STACK_SIZE);
+		++cpu_count;
+	}
+}
+
+// Un SIPI, un second s'il n'a pas suffi, puis attente du passage online.
+// On ne passe au suivant qu'apres: les parametres du trampoline sont partages.
+static void	start_ap(t_cpu *cpu, t_trampoline_params *params)
+{
+	u64	start;
+	u64	deadline;
+
+	params->stack_top = cpu->stack_top;
+	params->cpu = cpu->index;
+	cpu->state = CPU_STARTING;
+	start = rdtsc();
+	lapic_send_ipi(cpu->apic_id, LAPIC_ICR_STARTUP | SMP_SIPI_VECTOR);
+	timer_sleep_us(SMP_SIPI_DELAY_US);
+	if (cpu->state != CPU_ONLINE)
+		lapic_send_ipi(cpu->apic_id, LAPIC_ICR_STARTUP | SMP_SIPI_VECTOR);
+	deadline = timer_now_us() + SMP_START_TIMEOUT_US;
+	while (cpu->state != CPU_ONLINE && timer_now_us() < deadline)
+		__asm__ volatile ("pause");
+	if (cpu->state != CPU_ONLINE)
+	{
+		cpu->state = CPU_FAILED;
+		return ;
+	}
+	cpu->start_kcycles = div64_32(rdtsc() - start, 1000, NULL);
+}
+
+// Sans MADT (pas d'ACPI), le BSP reste seul mais a quand meme sa zone par CPU
+void	smp_init(void)
+{
+	const t_acpi_madt	*madt;
+	t_trampoline_params	*params;
+
+	cpu_setup(0, 0, (u32)stack_top);
+	cpus[0].state = CPU_ONLINE;
+	gdt_load_cpu(0);
+
+	madt = (const t_acpi_madt *)acpi_find_table("APIC");
+	if (!madt)
+		return ;
+	lapic_map(madt);
+	cpus[0].apic_id = lapic_read(LAPIC_ID) >> 24;
+	idt_set_gate(LAPIC_SPURIOUS_VECTOR, (u32)isr_spurious, IDT_KERNEL_CODE_SELECTOR, IDT_INTERRUPT_GATE);
+	lapic_enable();
+	madt_add_cpus(madt);
+	if (cpu_count == 1)
+		return ;
+
+	ft_memcpy((void *)SMP_TRAMPOLINE, smp_trampoline_start, smp_trampoline_end - smp_trampoline_start);
+	params = (t_trampoline_params *)(SMP_TRAMPOLINE + (smp_trampoline_params - smp_trampoline_start));
+	params->gdt_ptr = gdt_ptr;
+	__asm__ volatile ("mov %%cr0, %0" : "=r"(params->cr0));
+	__asm__ volatile ("mov %%cr3, %0" : "=r"(params->cr3));
+	__asm__ volatile ("mov %%cr4, %0" : "=r"(params->cr4));
+	params->entry = (u32)ap_main;
+
+	// Tous les INIT d'abord: un seul delai de 10 ms pour l'ensemble des APs
+	for (u32 index = 1; index < cpu_count; ++index)
+		lapic_send_ipi(cpus[index].apic_id, LAPIC_ICR_INIT | LAPIC_ICR_ASSERT);
+	timer_sleep_ms(SMP_INIT_DELAY_MS);
+	for (u32 index = 1; index < cpu_count; ++index)
+		start_ap(&cpus[index], params);
+}
+
+u32	smp_cpu_count(void)
+{
+	return (cpu_count);
+}
+
+static void	command_cpus(const char *args)
+{
+	u32	online = 0;
+
+	(void)args;
+	terminal_set_color(VGA_COLOR_WHITE);
+	printk("CPU APIC state     stack       start\n");
+	for (u32 index = 0; index < cpu_count; ++index)
+	{
+		t_cpu	*cpu = &cpus[index];
+
+		printk("%-3u %-4u %-9s 0x%08x  ", index, cpu->apic_id,
+			cpu_state_names[cpu->state], cpu->stack_top);
+		if (index == 0)
+			printk("bsp\n");
+		else if (cpu->state == CPU_ONLINE)
+			printk("%u kcycles\n", cpu->start_kcycles);
+		else
+			printk("-\n");
+		online += (cpu->state == CPU_ONLINE);
+	}
+	printk("%u/%u CPUs online, shell on CPU %u\n", online, cpu_count, this_cpu()->index);
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+}
+
+SHELL_COMMAND("cpus", "cpus", "CPUs started through the MADT", command_cpus);
@@ -0,0 +1,71 @@
+; **************************************************************************** ;
+;                                                                              ;
+;                                                         :::      ::::::::    ;
+;    smp_trampoline.s                                   :+:      :+:    :+:    ;
+;                                                     +:+ +:+         +:+      ;
+;    By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+         ;
+;                                                 +#+#+#+#+#+   +#+            ;
+;    Created: 2026/02/11 14:20:09 by lumugot           #+#    #+#              ;
+;    Updated: 2026/02/13 11:05:52 by lumugot          ###   ########.fr        ;
+;                                                                              ;
+; **************************************************************************** ;
+
+; Code de demarrage des APs. smp_init le recopie a SMP_TRAMPOLINE et remplit
+; smp_trampoline_params (t_trampoline_params, smp.h) avant chaque SIPI.
+; Un AP y arrive en real mode, cs:ip = 0x0800:0000.
+
+%define TRAMPOLINE	0x8000
+; Adresse d'un label une fois la copie faite
+%define REL(label)	(TRAMPOLINE + (label) - smp_trampoline_start)
+%define PARAM(off)	(REL(smp_trampoline_params) + (off))
+
+section .rodata
+
+global	smp_trampoline_start
+global	smp_trampoline_params
+global	smp_trampoline_end
+
+BITS	16
+smp_trampoline_start:
+	cli
+	cld
+	xor		ax, ax
+	mov		ds, ax
+	; La GDT du noyau (0x800): memes selecteurs 0x08/0x10 que le BSP
+	o32 lgdt	[PARAM(0)]
+	mov		eax, cr0
+	or		eax, 1
+	mov		cr0, eax
+	jmp		dword 0x08:REL(.protected)
+
+BITS	32
+.protected:
+	mov		ax, 0x10
+	mov		ds, ax
+	mov		es, ax
+	mov		fs, ax
+	mov		gs, ax
+	mov		ss, ax
+
+	; CR4 (PSE, PGE, SSE) et CR3 avant d'activer la pagination par CR0
+	mov		eax, [PARAM(12)]
+	mov		cr4, eax
+	mov		eax, [PARAM(8)]
+	mov		cr3, eax
+	mov		eax, [PARAM(16)]
+	mov		cr0, eax
+
+	mov		esp, [PARAM(20)]
+	push	dword [PARAM(28)]
+	mov		eax, [PARAM(24)]
+	call	eax
+
+.hang:
+	cli
+	hlt
+	jmp		.hang
+
+align 4
+smp_trampoline_params:
+	times 32 db 0
+smp_trampoline_end:
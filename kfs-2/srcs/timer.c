@@ -0,0 +1,224 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   timer.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/01/25 10:03:40 by lumugot           #+#    #+#             */
+/*   Updated: 2026/01/25 16:48:30 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/timer.h"
+#include "../includes/idt.h"
+#include "../includes/pic.h"
+#include "../includes/io.h"
+#include "../includes/div64.h"
+
+// Pas de tick periodique: le PIT est programme en one-shot (mode 0) sur la
+// prochaine echeance du tas, ou sur son maximum (~55 ms) si rien n'est prevu,
+// le temps de repasser le compteur 16 bits dans ticks_base.
+static volatile u64	ticks_base = 0;
+static volatile u16	programmed = PIT_MAX_COUNT;
+
+static t_timer		heap[TIMER_MAX];
+static size_t		heap_size = 0;
+
+static void	pit_program(u16 count)
+{
+	outb(PIT_COMMAND, PIT_MODE_ONESHOT);
+	outb(PIT_CHANNEL0, count & 0xFF);
+	outb(PIT_CHANNEL0, (count >> 8) & 0xFF);
+	programmed = count;
+}
+
+static u16	pit_read_count(void)
+{
+	u8	low;
+	u8	high;
+
+	outb(PIT_COMMAND, PIT_LATCH_CH0);
+	low = inb(PIT_CHANNEL0);
+	high = inb(PIT_CHANNEL0);
+	return ((high << 8) | low);
+}
+
+// Ticks ecoules dans la periode en cours, interruptions coupees.
+// Apres 0 le compteur reboucle sur 0xFFFF: on s'arrete alors a programmed.
+static u32	pit_elapsed(void)
+{
+	u16	count = pit_read_count();
+
+	if (count > programmed || (pic_get_irr() & (1 << IRQ_TIMER)))
+		return (programmed);
+	return (programmed - count);
+}
+
+static void	heap_swap(size_t a, size_t b)
+{
+	t_timer	tmp = heap[a];
+
+	heap[a] = heap[b];
+	heap[b] = tmp;
+}
+
+static void	heap_push(t_timer *timer)
+{
+	size_t	index = heap_size++;
+
+	heap[index] = *timer;
+	while (index > 0 && heap[(index - 1) / 2].deadline > heap[index].deadline)
+	{
+		heap_swap(index, (index - 1) / 2);
+		index = (index - 1) / 2;
+	}
+}
+
+static void	heap_pop(void)
+{
+	size_t	index = 0;
+
+	heap[0] = heap[--heap_size];
+	while (1)
+	{
+		size_t	left = index * 2 + 1;
+		size_t	smallest = index;
+
+		if (left < heap_size && heap[left].deadline < heap[smallest].deadline)
+			smallest = left;
+		if (left + 1 < heap_size && heap[left + 1].deadline < heap[smallest].deadline)
+			smallest = left + 1;
+		if (smallest == index)
+			break ;
+		heap_swap(index, smallest);
+		index = smallest;
+	}
+}
+
+static void	timer_program_next(u64 now)
+{
+	u64	delta = PIT_MAX_COUNT;
+
+	if (heap_size && heap[0].deadline <= now)
+		delta = PIT_MIN_COUNT;
+	else if (heap_size && heap[0].deadline - now < delta)
+		delta = heap[0].deadline - now;
+	if (delta < PIT_MIN_COUNT)
+		delta = PIT_MIN_COUNT;
+	pit_program(delta);
+}
+
+static void	timer_irq(t_registers *regs)
+{
+	u16	count = pit_read_count();
+	u64	now;
+
+	(void)regs;
+	// Mode 0: l'IRQ arrive toujours apres le passage a zero, le compteur a
+	// deja reboucle depuis 0xFFFF. On rattrape ce depassement, y compris
+	// au repos ou programmed vaut deja PIT_MAX_COUNT.
+	ticks_base += programmed;
+	ticks_base += (0x10000 - count) & 0xFFFF;
+	now = ticks_base;
+
+	while (heap_size && heap[0].deadline <= now)
+	{
+		t_timer	expired = heap[0];
+
+		heap_pop();
+		expired.callback(expired.arg);
+	}
+	timer_program_next(now);
+}
+
+void	timer_init(void)
+{
+	pit_program(PIT_MAX_COUNT);
+	irq_register_handler(IRQ_TIMER, timer_irq);
+}
+
+u64	timer_now_ticks(void)
+{
+	u32	flags = irq_save();
+	u64	now = ticks_base + pit_elapsed();
+
+	irq_restore(flags);
+	return (now);
+}
+
+u64	timer_ticks_to_us(u64 ticks)
+{
+	u32	rem;
+	u32	sec = div64_32(ticks, PIT_FREQUENCY, &rem);
+
+	return ((u64)sec * 1000000 + div64_32((u64)rem * 1000000, PIT_FREQUENCY, NULL));
+}
+
+u64	timer_us_to_ticks(u64 us)
+{
+	u32	rem;
+	u32	sec = div64_32(us, 1000000, &rem);
+
+	return ((u64)sec * PIT_FREQUENCY + div64_32((u64)rem * PIT_FREQUENCY, 1000000, NULL));
+}
+
+u64	timer_now_us(void)
+{
+	return (timer_ticks_to_us(timer_now_ticks()));
+}
+
+// Le callback s'execute dans l'IRQ0, il doit rester court
+bool	timer_add(u64 delay_us, t_timer_callback callback, void *arg)
+{
+	u32		flags = irq_save();
+	u64		now = ticks_base + pit_elapsed();
+	t_timer	timer;
+
+	if (heap_size == TIMER_MAX)
+	{
+		irq_restore(flags);
+		return (false);
+	}
+	timer.deadline = now + timer_us_to_ticks(delay_us);
+	timer.callback = callback;
+	timer.arg = arg;
+	heap_push(&timer);
+
+	// Nouvelle echeance la plus proche: on clot la periode en cours et on
+	// reprogramme le PIT tout de suite, sauf si l'IRQ0 est deja en attente
+	// (elle comptera la periode et reprogrammera elle-meme)
+	if (heap[0].deadline == timer.deadline && !(pic_get_irr() & (1 << IRQ_TIMER)))
+	{
+		ticks_base = now;
+		timer_program_next(now);
+	}
+	irq_restore(flags);
+	return (true);
+}
+
+static void	timer_wake(void *arg)
+{
+	*(volatile bool *)arg = true;
+}
+
+void	timer_sleep_us(u64 us)
+{
+	volatile bool	done = false;
+
+	if (!timer_add(us, timer_wake, (void *)&done))
+		return ;
+	while (!done)
+	{
+		asm volatile ("cli");
+		if (!done)
+			asm volatile ("sti; hlt");
+		else
+			asm volatile ("sti");
+	}
+}
+
+void	timer_sleep_ms(u32 ms)
+{
+	timer_sleep_us((u64)ms * 1000);
+}
@@ -0,0 +1,161 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   trace.c                                            :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: lumugot <lumugot@42angouleme.fr>           +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/02/04 10:21:02 by lumugot           #+#    #+#             */
+/*   Updated: 2026/02/04 18:02:11 by lumugot          ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/trace.h"
+#include "../includes/kernel.h"
+#include "../includes/io.h"
+#include "../includes/serial.h"
+#include "../includes/shell.h"
+
+#ifdef KFS_TRACE
+
+static t_trace_event	events[TRACE_EVENTS];
+static u32				trace_head = 0;
+static bool				trace_paused = false;
+
+// B/E: debut et fin d'une duree, I: evenement ponctuel (format chrome://tracing)
+static const struct
+{
+	const char	*name;
+	char		phase;
+}	trace_names[TRACE_ID_COUNT] = {
+	[TRACE_NONE] = {"none", 'I'},
+	[TRACE_KEYBOARD_IRQ] = {"keyboard_irq", 'I'},
+	[TRACE_SCANCODE_BEGIN] = {"scancode", 'B'},
+	[TRACE_SCANCODE_END] = {"scancode", 'E'},
+	[TRACE_PUTCHAR] = {"putchar", 'I'},
+	[TRACE_FLUSH_BEGIN] = {"flush", 'B'},
+	[TRACE_FLUSH_END] = {"flush", 'E'},
+	[TRACE_CURSOR] = {"cursor", 'I'},
+	[TRACE_SCROLL] = {"scroll", 'I'},
+	[TRACE_SWITCH] = {"switch", 'I'},
+	[TRACE_COMMAND_BEGIN] = {"command", 'B'},
+	[TRACE_COMMAND_END] = {"command", 'E'},
+};
+
+// Sans verrou: lock xadd reserve la case, une IRQ qui trace au milieu
+// prend simplement la suivante
+void	trace_record(u32 id, u32 arg0, u32 arg1)
+{
+	if (trace_paused)
+		return ;
+
+	u32				slot = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED) & TRACE_MASK;
+	t_trace_event	*event = &events[slot];
+
+	event->tsc = rdtsc();
+	event->id = id;
+	event->arg0 = arg0;
+	event->arg1 = arg1;
+}
+
+// Plus ancien evenement encore present dans l'anneau
+static u32	trace_first(u32 head)
+{
+	return (head > TRACE_EVENTS ? head - TRACE_EVENTS : 0);
+}
+
+static void	trace_dump(void)
+{
+	u32	head = trace_head;
+	u32	first = trace_first(head);
+	u64	base;
+
+	if (head - first > TRACE_DUMP_EVENTS)
+		first = head - TRACE_DUMP_EVENTS;
+	if (first == head)
+	{
+		printk("trace: empty\n");
+		return ;
+	}
+	base = events[first & TRACE_MASK].tsc;
+	printk("%u events recorded, last %u (cycles since the first shown):\n", head, head - first);
+	for (u32 index = first; index < head; ++index)
+	{
+		t_trace_event	*event = &events[index & TRACE_MASK];
+		u32				id = event->id < TRACE_ID_COUNT ? event->id : TRACE_NONE;
+
+		printk("%u %c %s 0x%x 0x%x\n", (u32)(event->tsc - base),
+			trace_names[id].phase, trace_names[id].name, event->arg0, event->arg1);
+	}
+}
+
+static char	*put_hex(char *out, u32 value, int digits)
+{
+	while (digits--)
+		*out++ = "0123456789abcdef"[(value >> (digits * 4)) & 0xF];
+	return (out);
+}
+
+static char	*put_string(char *out, const char *str)
+{
+	while (*str)
+		*out++ = *str++;
+	return (out);
+}
+
+// Tout l'anneau sur COM1 seulement, une ligne par evenement:
+// TRACE <tsc> <phase> <nom> <arg0> <arg1>, pour un traitement hors ligne
+static void	trace_drain_serial(void)
+{
+	u32		head = trace_head;
+	char	line[64];
+
+	for (u32 index = trace_first(head); index < head; ++index)
+	{
+		t_trace_event	*event = &events[index & TRACE_MASK];
+		u32				id = event->id < TRACE_ID_COUNT ? event->id : TRACE_NONE;
+		char			*out = put_string(line, "TRACE ");
+
+		out = put_hex(out, (u32)(event->tsc >> 32), 8);
+		out = put_hex(out, (u32)event->tsc, 8);
+		*out++ = ' ';
+		*out++ = trace_names[id].phase;
+		*out++ = ' ';
+		out = put_string(out, trace_names[id].name);
+		*out++ = ' ';
+		out = put_hex(out, event->arg0, 8);
+		*out++ = ' ';
+		out = put_hex(out, event->arg1, 8);
+		*out++ = '\n';
+		// Bloque quand l'anneau TX est plein, rien n'est perdu
+		serial_write(line, out - line);
+	}
+	printk("trace: %u events sent to COM1\n", head - trace_first(head));
+}
+
+static void	command_trace(const char *args)
+{
+	// La commande elle-meme ne doit pas remplir l'anneau qu'elle lit
+	trace_paused = true;
+	terminal_set_color(VGA_COLOR_WHITE);
+	if (ft_strncmp(args, "serial", 7) == 0)
+		trace_drain_serial();
+	else if (ft_strncmp(args, "clear", 6) == 0)
+		trace_head = 0;
+	else
+		trace_dump();
+	terminal_set_color(VGA_COLOR_LIGHT_RED2);
+	trace_paused = false;
+}
+
+#else
+
+static void	command_trace(const char *args)
+{
+	(void)args;
+	printk("trace: compiled out, build with -DKFS_TRACE\n");
+}
+
+#endif
+
+SHELL_COMMAND("trace", "trace [opt]", "last events, 'serial' or 'clear'", command_trace);